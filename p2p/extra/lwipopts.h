@@ -2,16 +2,31 @@
 
 #define MEM_LIBC_MALLOC 1
 #define MEMP_MEM_MALLOC 1
-#define MEMP_NUM_NETCONN 32
+// each WebRTC socket a Remote hosts is a netconn, and lwIP's socket table
+// is sized by this; LwipSocketServer's Wait no longer scans it
+#define MEMP_NUM_NETCONN 4096
 
 #define LWIP_UDP 1
 
 #define LWIP_TCP 1
-#define TCP_WND 0xffff
 #define LWIP_TCP_SACK_OUT 1
+#define LWIP_TCP_TIMESTAMPS 1
+
+#ifdef ORC_LWIP_BANDWIDTH
+// a tunnel's RTT is long, and window / RTT bounds what one connection gets
+#define LWIP_WND_SCALE 1
+#define TCP_RCV_SCALE 5
+#define TCP_WND (1024 * 1024)
+#define TCP_MSS 1200
+#define TCP_SND_BUF (1024 * 1024)
+#define TCP_SND_QUEUELEN (4 * TCP_SND_BUF / TCP_MSS)
+// the default (half of TCP_SND_BUF) would not fit lwIP's 16-bit tcp_sndbuf
+#define TCP_SNDLOWAT (16 * TCP_MSS)
+#else
+#define TCP_WND 0xffff
 #define TCP_MSS 512
 #define TCP_SND_BUF 0xffff
-#define LWIP_TCP_TIMESTAMPS 1
+#endif
 
 #define LWIP_NETIF_API 1
 #define LWIP_HAVE_LOOPIF 1
@@ -21,6 +36,8 @@
 #define LWIP_COMPAT_SOCKETS 0
 #define LWIP_TCP_KEEPALIVE 0
 #define LWIP_SOCKET_POLL 0
+// LwipSocketServer installs its own netconn callback instead
+#define LWIP_SOCKET_SELECT 0
 
 struct netif *hook_ip4_route_src(const void *src, const void *dest);
 #define LWIP_HOOK_IP4_ROUTE_SRC hook_ip4_route_src
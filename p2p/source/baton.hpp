@@ -35,6 +35,7 @@
 #include "error.hpp"
 #include "event.hpp"
 #include "task.hpp"
+#include "trace.hpp"
 
 namespace orc {
 
@@ -110,14 +111,18 @@ template <typename Type_, typename... Values_>
 class Handler {
   public:
     Baton<Type_, Values_...> *baton_;
+    uint64_t flow_;
 
   public:
     Handler(Baton<Type_, Values_...> *baton) :
-        baton_(baton)
+        baton_(baton),
+        flow_(Depart("asio"))
     {
     }
 
     void operator()(Values_... values) {
+        Traced traced("asio");
+        Arrive("asio", flow_);
         (*baton_)(std::move(values)...);
     }
 };
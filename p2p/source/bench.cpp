@@ -0,0 +1,122 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include "bench.hpp"
+#include "log.hpp"
+#include "wheel.hpp"
+
+namespace orc {
+
+std::atomic<Histogram *> Histogram::histograms_(nullptr);
+
+Histogram::Histogram(const char *name) :
+    name_(name)
+{
+    next_ = histograms_.load();
+    while (!histograms_.compare_exchange_weak(next_, this));
+}
+
+uint64_t Histogram::Value(size_t index) {
+    if (index < (size_t(1) << Bits))
+        return index;
+    index -= size_t(1) << Bits;
+    const auto shift(index / Half + 1);
+    const auto top(index % Half + Half);
+    // the very last bucket ends at the top of the range, where this wraps
+    return ((top + 1) << shift) - 1;
+}
+
+Histogram::Snapshot Histogram::Take() const {
+    Snapshot snapshot;
+    snapshot.buckets_.resize(Buckets);
+    for (size_t i(0); i != Buckets; ++i) {
+        const auto count(buckets_[i].load(std::memory_order_relaxed));
+        snapshot.buckets_[i] = count;
+        // count_ is bumped separately, so derive it from what we actually read
+        snapshot.count_ += count;
+    }
+    snapshot.sum_ = sum_.load(std::memory_order_relaxed);
+    snapshot.maximum_ = maximum_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+uint64_t Histogram::Snapshot::operator [](double quantile) const {
+    if (count_ == 0)
+        return 0;
+    const auto rank(std::max<uint64_t>(uint64_t(quantile * count_ + 0.5), 1));
+    uint64_t seen(0);
+    for (size_t i(0); i != buckets_.size(); ++i)
+        if ((seen += buckets_[i]) >= rank)
+            return std::min(Value(i), maximum_);
+    return maximum_;
+}
+
+static const struct {
+    double value_;
+    const char *label_;
+} Quantiles[] = {
+    {0.5, "0.5"},
+    {0.9, "0.9"},
+    {0.99, "0.99"},
+    {0.999, "0.999"},
+};
+
+std::ostream &operator <<(std::ostream &out, const Histogram::Snapshot &snapshot) {
+    out << std::dec << snapshot.count() << "x" << std::fixed << std::setprecision(3);
+    for (const auto &quantile : Quantiles)
+        out << " q" << quantile.label_ << "=" << snapshot[quantile.value_] / 1e6 << "ms";
+    out << " max=" << snapshot.maximum() / 1e6 << "ms" << std::defaultfloat;
+    return out;
+}
+
+void Metrics(std::ostream &out) {
+    out << std::defaultfloat << std::setprecision(9);
+    Histogram::Each([&](const Histogram &histogram) {
+        const auto snapshot(histogram.Take());
+        const auto name(histogram.Name());
+        for (const auto &quantile : Quantiles)
+            out << "orchid_latency_seconds{name=\"" << name << "\",quantile=\"" << quantile.label_ << "\"} " << snapshot[quantile.value_] / 1e9 << "\n";
+        out << "orchid_latency_seconds_sum{name=\"" << name << "\"} " << snapshot.sum() / 1e9 << "\n";
+        out << "orchid_latency_seconds_count{name=\"" << name << "\"} " << std::dec << snapshot.count() << "\n";
+    });
+}
+
+void Summarize(unsigned milliseconds) {
+    // this is leaked, as the wheel could be firing it while the process exits
+    static Timer *const timer(new Timer([milliseconds]() {
+        Histogram::Each([&](const Histogram &histogram) {
+            const auto snapshot(histogram.Take());
+            if (snapshot.count() != 0)
+                Log() << "Bench(\"" << histogram.Name() << "\") = " << snapshot << std::endl;
+        });
+        timer->Set(milliseconds);
+    }));
+    timer->Set(milliseconds);
+}
+
+}
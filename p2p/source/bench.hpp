@@ -20,38 +20,127 @@
 /* }}} */
 
 
+
+
 #ifndef ORCHID_BENCH_HPP
 #define ORCHID_BENCH_HPP
 
-#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+#include <vector>
 
-#include <sys/time.h>
+namespace orc {
 
-#include "log.hpp"
+// Histogram aggregates latencies (in nanoseconds) into HDR-style buckets:
+// exact below 128, then 64 buckets per power of two, so every recorded
+// value is within 1.6%; recording is a few relaxed atomic operations
 
-namespace orc {
+class Histogram {
+  public:
+    static const unsigned Bits = 7;
+    static const size_t Half = size_t(1) << (Bits - 1);
+    static const size_t Buckets = (size_t(1) << Bits) + (64 - Bits) * Half;
+
+    class Snapshot {
+        friend class Histogram;
+
+      private:
+        std::vector<uint64_t> buckets_;
+        uint64_t count_ = 0;
+        uint64_t sum_ = 0;
+        uint64_t maximum_ = 0;
+
+      public:
+        uint64_t count() const {
+            return count_; }
+        uint64_t sum() const {
+            return sum_; }
+        uint64_t maximum() const {
+            return maximum_; }
+
+        // the highest value equivalent to the given quantile, such as 0.99
+        uint64_t operator [](double quantile) const;
+    };
 
-class Bench {
   private:
+    static std::atomic<Histogram *> histograms_;
+
     const char *const name_;
-    timeval start_;
+    Histogram *next_ = nullptr;
+
+    std::atomic<uint64_t> buckets_[Buckets] = {};
+    std::atomic<uint64_t> count_ = 0;
+    std::atomic<uint64_t> sum_ = 0;
+    std::atomic<uint64_t> maximum_ = 0;
+
+    static size_t Index(uint64_t value) {
+        if (value < (uint64_t(1) << Bits))
+            return value;
+        const unsigned shift(63 - __builtin_clzll(value) - (Bits - 1));
+        return (size_t(1) << Bits) + (shift - 1) * Half + (value >> shift) - Half;
+    }
 
   public:
-    Bench(const char *name) :
-        name_(name)
+    // instances register themselves, so keep them static: they are never removed
+    Histogram(const char *name);
+
+    Histogram(const Histogram &histogram) = delete;
+
+    const char *Name() const {
+        return name_; }
+
+    void Record(uint64_t nanoseconds) noexcept {
+        buckets_[Index(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(nanoseconds, std::memory_order_relaxed);
+        auto maximum(maximum_.load(std::memory_order_relaxed));
+        while (nanoseconds > maximum && !maximum_.compare_exchange_weak(maximum, nanoseconds, std::memory_order_relaxed));
+    }
+
+    Snapshot Take() const;
+
+    // the highest value that lands in the given bucket
+    static uint64_t Value(size_t index);
+
+    template <typename Code_>
+    static void Each(Code_ &&code) {
+        for (auto histogram(histograms_.load()); histogram != nullptr; histogram = histogram->next_)
+            code(*histogram);
+    }
+};
+
+std::ostream &operator <<(std::ostream &out, const Histogram::Snapshot &snapshot);
+
+// Bench times its scope, which may span co_awaits, into a histogram
+class Bench {
+  private:
+    Histogram &histogram_;
+    const uint64_t start_;
+
+  public:
+    static uint64_t Now() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    Bench(Histogram &histogram, uint64_t start = Now()) :
+        histogram_(histogram),
+        start_(start)
     {
-        gettimeofday(&start_, NULL);
     }
 
+    Bench(const Bench &bench) = delete;
+
     ~Bench() {
-        timeval end;
-        gettimeofday(&end, NULL);
-        timeval diff;
-        timersub(&end, &start_, &diff);
-        Log() << "Bench(\"" << name_ << "\") = " << diff.tv_sec << "." << std::setfill('0') << std::setw(6) << diff.tv_usec << std::endl;
+        histogram_.Record(Now() - start_);
     }
 };
 
+// every histogram as Prometheus summaries, for a metrics endpoint
+void Metrics(std::ostream &out);
+// log every histogram that has data, repeating on the given period
+void Summarize(unsigned milliseconds);
+
 }
 
 #endif//ORCHID_BENCH_HPP
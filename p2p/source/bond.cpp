@@ -0,0 +1,136 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include <openvpn/ip/ip4.hpp>
+
+#include "bond.hpp"
+#include "syscall.hpp"
+
+namespace orc {
+
+static Striping stripes_;
+
+void Stripes(const Striping &striping) {
+    orc_assert(striping.channels_ != 0);
+    stripes_ = striping;
+}
+
+Striping Stripes() {
+    return stripes_;
+}
+
+static uint64_t Mix(uint64_t value) {
+    // splitmix64's finalizer
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+    return value ^ (value >> 31);
+}
+
+// a hash of a TCP or UDP packet's 5-tuple, or 0 for anything else; this
+// runs for every packet, so it only gathers the headers it needs to read
+static uint64_t Hash(const Buffer &data) {
+    struct Header {
+        openvpn::IPv4Header ip4;
+        uint8_t rest[40 + 4];
+    } orc_packed;
+
+    Header header;
+
+    const auto base(reinterpret_cast<uint8_t *>(&header));
+    size_t have(0);
+    data.each([&](const uint8_t *data, size_t size) {
+        const auto writ(std::min(size, sizeof(header) - have));
+        Copy(base + have, data, writ);
+        have += writ;
+        return have != sizeof(header);
+    });
+
+    if (have < sizeof(header.ip4))
+        return 0;
+    const auto &ip4(header.ip4);
+    if (openvpn::IPCommon::version(ip4.version_len) != uint8_t(openvpn::IPCommon::IPv4))
+        return 0;
+    if (ip4.protocol != uint8_t(openvpn::IPCommon::TCP) && ip4.protocol != uint8_t(openvpn::IPCommon::UDP))
+        return 0;
+
+    uint64_t hash(Mix(uint64_t(ip4.saddr) << 32 | ip4.daddr) ^ ip4.protocol);
+
+    // later fragments carry no ports, and so are pinned by address alone
+    const auto length(openvpn::IPv4Header::length(ip4.version_len));
+    if ((boost::endian::big_to_native(ip4.frag_off) & 0x1fff) == 0 && have >= length + 4) {
+        uint32_t ports;
+        Copy(&ports, base + length, sizeof(ports));
+        hash = Mix(hash ^ ports);
+    }
+
+    return hash == 0 ? 1 : hash;
+}
+
+void Bonded::Publish(const Lock<Locked_> &locked) {
+    auto bundle(std::make_unique<Bundle>());
+    bundle->bondings_.reserve(locked->bondings_.size());
+    for (const auto &bonding : locked->bondings_)
+        bundle->bondings_.emplace_back(bonding.first);
+    bundle_.store(bundle.get(), std::memory_order_release);
+    locked->bundles_.emplace_back(std::move(bundle));
+}
+
+Bonded::Bonding *Bonded::Find(const Buffer &data) {
+    const auto bundle(bundle_.load(std::memory_order_acquire));
+    if (bundle == nullptr)
+        return nullptr;
+    const auto &bondings(bundle->bondings_);
+    const auto count(bondings.size());
+    if (count == 0)
+        return nullptr;
+    if (count == 1 || stripe_ == Stripe::First)
+        return bondings.front();
+
+    if (stripe_ == Stripe::Flow)
+        if (const auto hash = Hash(data)) {
+            // rendezvous hashing: when a bonding goes, only its flows move
+            Bonding *best(nullptr);
+            uint64_t score(0);
+            for (const auto bonding : bondings)
+                if (const auto value = Mix(hash ^ reinterpret_cast<uintptr_t>(bonding)); best == nullptr || value > score) {
+                    best = bonding;
+                    score = value;
+                }
+            return best;
+        }
+
+    // starting somewhere new each time turns ties (as when idle) into round robin
+    const auto size(data.size());
+    const auto start(next_.fetch_add(1, std::memory_order_relaxed));
+    Bonding *best(nullptr);
+    uint64_t cost(0);
+    for (size_t i(0); i != count; ++i) {
+        const auto bonding(bondings[(start + i) % count]);
+        if (const auto value = bonding->Cost(size); best == nullptr || value < cost) {
+            best = bonding;
+            cost = value;
+        }
+    }
+    return best;
+}
+
+}
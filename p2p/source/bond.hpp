@@ -23,15 +23,40 @@
 #ifndef ORCHID_BOND_HPP
 #define ORCHID_BOND_HPP
 
+#include <atomic>
 #include <set>
+#include <vector>
 
+#include "bench.hpp"
 #include "link.hpp"
 #include "locked.hpp"
 #include "parallel.hpp"
+#include "scope.hpp"
 #include "spawn.hpp"
 
 namespace orc {
 
+// how a Bonded spreads packets over its bondings: First puts everything on
+// the first one (as this always did); Weighted picks, per packet, whichever
+// should take it soonest; Flow does that for anything that isn't TCP or UDP
+// but hashes those by their 5-tuple, so a flow stays on one bonding in order
+
+enum class Stripe {
+    First,
+    Weighted,
+    Flow,
+};
+
+struct Striping {
+    // how many data channels a Client opens to its server per session
+    unsigned channels_ = 1;
+    Stripe stripe_ = Stripe::Flow;
+};
+
+// this sets the default for every Bonded (and Client) made afterwards
+void Stripes(const Striping &striping);
+Striping Stripes();
+
 class Bonded {
   private:
     class Bonding :
@@ -43,6 +68,12 @@ class Bonded {
       private:
         Bonded *const bonded_;
 
+        // bytes handed to Inner() that it hasn't taken yet, and a moving
+        // average of how long it has been taking (which, with Channel's
+        // flow control behind it, grows with both RTT and buffered amount)
+        std::atomic<uint64_t> pending_ = 0;
+        std::atomic<uint64_t> delay_ = 0;
+
       protected:
         void Land(const Buffer &data) override {
             return bonded_->Land(this, data);
@@ -59,20 +90,49 @@ class Bonded {
         {
         }
 
+        // roughly how long a packet of this size would wait before Inner()
+        // took it; only ever compared against other bondings' costs
+        uint64_t Cost(size_t size) const {
+            return (pending_.load(std::memory_order_relaxed) + size) * (delay_.load(std::memory_order_relaxed) + 1);
+        }
+
         task<void> Shut() noexcept override {
             co_await Sunken::Shut();
             co_await Valve::Shut();
         }
 
         task<void> Send(const Buffer &data) override {
+            const auto size(data.size());
+            pending_.fetch_add(size, std::memory_order_relaxed);
+            const auto start(Bench::Now());
+            _scope({
+                pending_.fetch_sub(size, std::memory_order_relaxed);
+                // racing updates lose a sample, which an average can afford
+                const auto delay(delay_.load(std::memory_order_relaxed));
+                delay_.store(delay - delay / 8 + (Bench::Now() - start) / 8, std::memory_order_relaxed);
+            });
             co_return co_await Inner().Send(data);
         }
     };
 
+    // Find reads bondings from an immutable snapshot without locking; they
+    // are replaced (under the lock) when a bonding comes or goes, and as a
+    // Find might still be reading an old one, they are kept until the end
+    struct Bundle {
+        std::vector<Bonding *> bondings_;
+    };
+
+    const Stripe stripe_;
+    std::atomic<const Bundle *> bundle_ = nullptr;
+    std::atomic<unsigned> next_ = 0;
+
     struct Locked_ {
         std::map<Bonding *, U<Bonding>> bondings_;
+        std::vector<U<const Bundle>> bundles_;
     }; Locked<Locked_> locked_;
 
+    void Publish(const Lock<Locked_> &locked);
+
   protected:
     virtual void Land(Pipe<Buffer> *pipe, const Buffer &data) = 0;
 
@@ -86,28 +146,29 @@ class Bonded {
                 co_await bonding->Shut();
             }, __FUNCTION__);
         locked->bondings_.erase(iterator);
+        Publish(locked);
         if (locked->bondings_.empty())
             Stop();
     }
 
   public:
+    Bonded(Stripe stripe = Stripes().stripe_) :
+        stripe_(stripe)
+    {
+    }
+
     BufferSink<Bonding> &Bond() {
         // XXX: this is non-obviously incorrect
         const auto locked(locked_());
         auto bonding(std::make_unique<Covered<BufferSink<Bonding>>>(this));
         auto &backup(*bonding);
         locked->bondings_.emplace(&backup, std::move(bonding));
+        Publish(locked);
         return backup;
     }
 
-    Bonding *Find() {
-        // XXX: this lock isn't sufficient
-        const auto locked(locked_());
-        const auto bonding(locked->bondings_.begin());
-        if (bonding == locked->bondings_.end())
-            return nullptr;
-        return bonding->first;
-    }
+    // XXX: a Send that found a bonding can still race that bonding's Stop
+    Bonding *Find(const Buffer &data);
 
     task<void> Shut() noexcept {
         std::vector<task<void>> shuts;
@@ -121,7 +182,7 @@ class Bonded {
     }
 
     task<void> Send(const Buffer &data) {
-        if (const auto bonding = Find())
+        if (const auto bonding = Find(data))
             co_await bonding->Send(data);
     }
 };
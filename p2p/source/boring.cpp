@@ -31,7 +31,6 @@ extern "C" {
 #include "boring.hpp"
 #include "forge.hpp"
 #include "origin.hpp"
-#include "sleep.hpp"
 
 namespace orc {
 
@@ -52,7 +51,7 @@ void Boring::Land(const Buffer &data) {
             case WRITE_TO_NETWORK: {
                 nest_.Hatch([&]() noexcept { return [this, data = std::move(output), size = result.size]() -> task<void> {
                     co_await Inner().Send(data.subset(0, size));
-                }; }, __FUNCTION__);
+                }; }, __FUNCTION__, Priority::Data);
                 input.clear();
                 continue;
             } break;
@@ -85,49 +84,50 @@ Boring::Boring(BufferDrain &drain, uint32_t local, const Host &remote, const std
     remote_(remote),
     wireguard_(new_tunnel(secret.c_str(), common.c_str(), [](const char *message) {
         Log() << "WireGuard: " << message << std::endl;
-    }, ALL))
+    }, ALL)),
+    tick_([this]() { Tick(); })
 {
 }
 
 Boring::~Boring() {
+    // a Tick() might be running on the wheel even if we were never Shut()
+    tick_.Cancel();
     tunnel_free(wireguard_);
 }
 
-void Boring::Open() {
-    // XXX: use the same joinable thing I end up using in Transport
-    Spawn([&]() noexcept -> task<void> {
-        Beam output(148);
-        while (!stop_) {
-            const auto result(wireguard_tick(wireguard_, output.data(), output.size()));
-            switch (result.op) {
-                case WIREGUARD_DONE:
-                    break;
-
-                case WRITE_TO_NETWORK:
-                    co_await Inner().Send(output.subset(0, result.size));
-                    break;
-
-                case WIREGUARD_ERROR:
-                    Error();
-                    break;
-
-                case WRITE_TO_TUNNEL_IPV4:
-                case WRITE_TO_TUNNEL_IPV6:
-                    orc_insist(false);
-            }
-
-            co_await Sleep(100);
-        }
+void Boring::Tick() {
+    Beam output(148);
+    const auto result(wireguard_tick(wireguard_, output.data(), output.size()));
+    switch (result.op) {
+        case WIREGUARD_DONE:
+            break;
+
+        case WRITE_TO_NETWORK:
+            nest_.Hatch([&]() noexcept { return [this, data = std::move(output), size = result.size]() -> task<void> {
+                co_await Inner().Send(data.subset(0, size));
+            }; }, __FUNCTION__, Priority::Data);
+            break;
+
+        case WIREGUARD_ERROR:
+            Error();
+            break;
+
+        case WRITE_TO_TUNNEL_IPV4:
+        case WRITE_TO_TUNNEL_IPV6:
+            orc_insist(false);
+    }
 
-        done_();
-    }, __FUNCTION__);
+    tick_.Set(100);
+}
+
+void Boring::Open() {
+    Tick();
 }
 
 task<void> Boring::Shut() noexcept {
-    stop_ = true;
+    tick_.Cancel();
     co_await nest_.Shut();
     co_await Sunken::Shut();
-    co_await *done_;
     co_await Link::Shut();
 }
 
@@ -26,6 +26,7 @@
 #include "link.hpp"
 #include "nest.hpp"
 #include "socket.hpp"
+#include "wheel.hpp"
 
 struct wireguard_tunnel;
 
@@ -43,11 +44,12 @@ class Boring :
 
     wireguard_tunnel *const wireguard_;
 
-    volatile bool stop_ = false;
     Nest nest_;
-    Event done_;
+    // every tunnel's 100ms tick shares the timing wheel rather than a loop
+    Timer tick_;
 
     void Error();
+    void Tick();
 
   protected:
     void Land(const Buffer &data) override;
@@ -124,7 +124,7 @@ static uint8_t Bless(char value) {
     orc_assert_(false, "'" << value << "' is not hex");
 }
 
-Beam Bless(const std::string &data) {
+Beam Bless(const std::string_view &data) {
     size_t size(data.size());
     orc_assert_((size & 1) == 0, "odd-length hex data");
     size >>= 1;
@@ -29,6 +29,7 @@
 #include <iostream>
 #include <list>
 #include <string>
+#include <string_view>
 
 #include <asio.hpp>
 
@@ -656,7 +657,7 @@ class Beam :
     }
 };
 
-Beam Bless(const std::string &data);
+Beam Bless(const std::string_view &data);
 
 template <typename Data_>
 inline bool operator ==(const Region &lhs, const std::string &rhs) {
@@ -1014,6 +1015,34 @@ class Builder :
     }
 };
 
+template <size_t Size_>
+class Mason {
+  private:
+    Brick<Size_> brick_;
+    size_t size_ = 0;
+
+  public:
+    void append(size_t count, uint8_t value) {
+        orc_insist(Size_ - size_ >= count);
+        memset(brick_.data() + size_, value, count);
+        size_ += count;
+    }
+
+    void operator +=(const Buffer &buffer) {
+        buffer.each([&](const uint8_t *data, size_t size) {
+            orc_insist(Size_ - size_ >= size);
+            memcpy(brick_.data() + size_, data, size);
+            size_ += size;
+            return true;
+        });
+    }
+
+    const Brick<Size_> &operator *() const {
+        orc_insist(size_ == Size_);
+        return brick_;
+    }
+};
+
 template <typename... Args_>
 struct Building;
 
@@ -1026,7 +1055,7 @@ template <typename Next_, typename... Rest_>
 struct Building<Next_, Rest_...> {
 static void Build(Builder &builder, Next_ &&next, Rest_ &&...rest) {
     Each(std::forward<Next_>(next), [&](const uint8_t *data, size_t size) {
-        builder += Beam(data, size);
+        builder.append(data, size);
         return true;
     });
     Building<Rest_...>::Build(builder, std::forward<Rest_>(rest)...);
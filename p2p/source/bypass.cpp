@@ -0,0 +1,106 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include <media/sctp/sctp_transport.h>
+#include <p2p/base/dtls_transport_internal.h>
+#include <pc/dtls_transport.h>
+#include <pc/sctp_transport.h>
+
+#include "bypass.hpp"
+#include "channel.hpp"
+#include "pirate.hpp"
+
+namespace orc {
+
+static std::atomic<bool> bypasses_(false);
+
+void Bypasses(bool bypass) {
+    bypasses_ = bypass;
+}
+
+bool Bypasses() {
+    return bypasses_;
+}
+
+// not an IP packet (its header would be at least 20 bytes)
+static const uint8_t Probe_[1] = {0x40};
+static const unsigned Probing_(250);
+
+struct OnPacketRead_ { typedef void (cricket::SctpTransport::*type)(rtc::PacketTransportInternal *, const char *, size_t, const int64_t &, int); };
+template struct Pirate<OnPacketRead_, &cricket::SctpTransport::OnPacketRead>;
+
+Bypass::Bypass(Channel &channel, rtc::Thread &thread, rtc::scoped_refptr<webrtc::SctpTransportInterface> transport) :
+    channel_(channel),
+    thread_(thread),
+    transport_(std::move(transport)),
+    dtls_([&]() {
+        const auto dtls(transport_->dtls_transport());
+        orc_assert(dtls != nullptr);
+        // NOLINTNEXTLINE (cppcoreguidelines-pro-type-static-cast-downcast)
+        const auto internal(static_cast<webrtc::DtlsTransport *>(dtls.get())->internal());
+        orc_assert(internal != nullptr);
+        return internal;
+    }()),
+    // NOLINTNEXTLINE (cppcoreguidelines-pro-type-static-cast-downcast)
+    sctp_(static_cast<cricket::SctpTransport *>(static_cast<webrtc::SctpTransport *>(transport_.get())->internal())),
+    batch_(thread)
+{
+    orc_assert(sctp_ != nullptr);
+    dtls_->SignalReadPacket.disconnect(sctp_);
+    dtls_->SignalReadPacket.connect(this, &Bypass::OnReadPacket);
+    OnMessage(nullptr);
+}
+
+Bypass::~Bypass() {
+    // the Channel holds the Peer, which can't have closed the transports
+    thread_.Clear(this);
+    dtls_->SignalReadPacket.disconnect(this);
+    dtls_->SignalReadPacket.connect(sctp_, Loot<OnPacketRead_>::pointer);
+}
+
+void Bypass::Write(const uint8_t *data, size_t size) noexcept {
+    // XXX: unlike SCTP, this doesn't fit packets to the path MTU, so IP may fragment them
+    dtls_->SendPacket(reinterpret_cast<const char *>(data), size, rtc::PacketOptions(), 0);
+}
+
+void Bypass::OnReadPacket(rtc::PacketTransportInternal *transport, const char *data, size_t size, const int64_t &time, int flags) {
+    const auto version(size == 0 ? 0 : uint8_t(data[0]) >> 4);
+    if (version != 4 && version != 6)
+        return (sctp_->*Loot<OnPacketRead_>::pointer)(transport, data, size, time, flags);
+
+    // the other side is listening; if this was its probe, it needs an answer
+    if (!ready_.exchange(true, std::memory_order_acq_rel))
+        Write(Probe_, sizeof(Probe_));
+    if (size == sizeof(Probe_))
+        return;
+
+    channel_.Land(Subset(data, size));
+}
+
+void Bypass::OnMessage(rtc::Message *message) {
+    if (Ready())
+        return;
+    Write(Probe_, sizeof(Probe_));
+    thread_.PostDelayed(RTC_FROM_HERE, Probing_, this);
+}
+
+}
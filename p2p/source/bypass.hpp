@@ -0,0 +1,119 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#ifndef ORCHID_BYPASS_HPP
+#define ORCHID_BYPASS_HPP
+
+#include <atomic>
+#include <string>
+
+#include <api/sctp_transport_interface.h>
+#include <rtc_base/message_handler.h>
+#include <rtc_base/third_party/sigslot/sigslot.h>
+
+#include "buffer.hpp"
+#include "threads.hpp"
+
+namespace cricket {
+class DtlsTransportInternal;
+class SctpTransport;
+}
+
+namespace rtc {
+class PacketTransportInternal;
+}
+
+namespace orc {
+
+class Channel;
+
+// whether Clients propose, and Servers agree to, bypassing SCTP
+void Bypasses(bool bypass);
+bool Bypasses();
+
+// Bypass carries a Channel's packets as bare DTLS application data over
+// the ICE pair its SCTP association runs on, without SCTP's reliability,
+// ordering or congestion control under the user's own. SCTP keeps using
+// the same DTLS transport: its packets start with its port (5000, 0x13..)
+// whereas every IP packet starts with its version (0x4. or 0x6.)
+
+class Bypass :
+    public rtc::MessageHandler,
+    public sigslot::has_slots<>
+{
+  private:
+    Channel &channel_;
+    rtc::Thread &thread_;
+    const rtc::scoped_refptr<webrtc::SctpTransportInterface> transport_;
+    cricket::DtlsTransportInternal *const dtls_;
+    cricket::SctpTransport *const sctp_;
+
+    Batch batch_;
+
+    // packets sent before the other side is listening would go to its SCTP,
+    // so this sends over SCTP, and probes, until something arrives directly
+    std::atomic<bool> ready_ = false;
+
+    class Sending :
+        public Job
+    {
+      public:
+        Bypass &bypass_;
+        const Beam data_;
+
+        Sending(Bypass &bypass, const Buffer &data) :
+            Job(bypass.batch_, Priority::Data),
+            bypass_(bypass),
+            data_(data)
+        {
+        }
+
+        bool Run() noexcept override {
+            bypass_.Write(data_.data(), data_.size());
+            return true;
+        }
+    };
+
+    void Write(const uint8_t *data, size_t size) noexcept;
+    void OnReadPacket(rtc::PacketTransportInternal *transport, const char *data, size_t size, const int64_t &time, int flags);
+
+  protected:
+    void OnMessage(rtc::Message *message) override;
+
+  public:
+    // these must be called on the network thread
+    Bypass(Channel &channel, rtc::Thread &thread, rtc::scoped_refptr<webrtc::SctpTransportInterface> transport);
+    ~Bypass() override;
+
+    bool Ready() const noexcept {
+        return ready_.load(std::memory_order_acquire);
+    }
+
+    task<void> Send(const Buffer &data) {
+        Sending sending(*this, data);
+        co_await sending;
+    }
+};
+
+}
+
+#endif//ORCHID_BYPASS_HPP
@@ -53,4 +53,18 @@ std::string Strip(const std::string &sdp) {
     return std::regex_replace(sdp, re, "");
 }
 
+std::string Propose(std::string sdp, const char *feature) {
+    // session attributes go before the first media section
+    const auto media(sdp.find("\r\nm="));
+    orc_assert(media != std::string::npos);
+    sdp.insert(media + 2, std::string("a=x-orchid-") + feature + "\r\n");
+    return sdp;
+}
+
+bool Proposed(const std::string &sdp, const char *feature) {
+    const auto media(sdp.find("\r\nm="));
+    const auto attribute(sdp.find(std::string("\r\na=x-orchid-") + feature + "\r\n"));
+    return attribute != std::string::npos && attribute < media;
+}
+
 }
@@ -20,6 +20,7 @@
 /* }}} */
 
 
+#include <cmath>
 #include <regex>
 
 #include "channel.hpp"
@@ -27,6 +28,142 @@
 
 namespace orc {
 
+static Flow flows_;
+
+void Flows(const Flow &flow) {
+    orc_assert(flow.low_ <= flow.high_);
+    orc_assert(flow.watermark_ <= flow.limit_);
+    flows_ = flow;
+}
+
+Flow Flows() {
+    return flows_;
+}
+
+bool Channel::Queue(Sending *sending) noexcept {
+    if (channel_->state() != webrtc::DataChannelInterface::kOpen) {
+        ++dropped_;
+        return true;
+    }
+
+    if (queue_.empty() && channel_->buffered_amount() < flow_.high_) {
+        channel_->Send(webrtc::DataBuffer(sending->buffer_, true));
+        return true;
+    }
+
+    if (queue_.size() >= flow_.watermark_)
+        switch (flow_.drop_) {
+            case Drop::Tail:
+                ++dropped_;
+                return true;
+
+            case Drop::Head:
+                queue_.pop_front();
+                ++dropped_;
+                break;
+
+            case Drop::None:
+            case Drop::Delay:
+                break;
+        }
+
+    // anyone already waiting goes first, so the packets stay in order
+    if (queue_.size() >= flow_.limit_ || waiting_ != nullptr) {
+        *tail_ = sending;
+        tail_ = &sending->next_;
+        return false;
+    }
+
+    queue_.push_back({std::move(sending->buffer_), Bench::Now()});
+    Drain();
+    return true;
+}
+
+bool Channel::Delay(uint64_t sojourn, uint64_t now) noexcept {
+    if (sojourn < flow_.target_) {
+        above_ = 0;
+        drops_ = 0;
+        return false;
+    }
+
+    if (above_ == 0) {
+        above_ = now + flow_.interval_;
+        return false;
+    }
+
+    if (now < above_ || now < again_)
+        return false;
+
+    // the longer the queue stands, the faster it drops, as in CoDel
+    ++drops_;
+    again_ = now + uint64_t(flow_.interval_ / std::sqrt(drops_));
+    return true;
+}
+
+void Channel::Drain() noexcept {
+    Stacked *admitted(nullptr), **tail(&admitted);
+
+    for (;;) {
+        while (!queue_.empty() && channel_->buffered_amount() < flow_.high_) {
+            const auto &queued(queue_.front());
+            const auto now(Bench::Now());
+            // CoDel keeps its state up to date, but only drops past the watermark
+            if (flow_.drop_ == Drop::Delay && Delay(now - queued.stamp_, now) && queue_.size() > flow_.watermark_)
+                ++dropped_;
+            else
+                channel_->Send(webrtc::DataBuffer(queued.buffer_, true));
+            queue_.pop_front();
+        }
+
+        if (waiting_ == nullptr || queue_.size() >= flow_.limit_)
+            break;
+
+        while (waiting_ != nullptr && queue_.size() < flow_.limit_) {
+            const auto sending(static_cast<Sending *>(waiting_));
+            waiting_ = sending->next_;
+            sending->next_ = nullptr;
+            queue_.push_back({std::move(sending->buffer_), Bench::Now()});
+            sending->flow_ = Depart("schedule");
+            *tail = sending;
+            tail = &sending->next_;
+        }
+
+        if (waiting_ == nullptr)
+            tail_ = &waiting_;
+    }
+
+    Resume(admitted);
+}
+
+task<void> Channel::Raw() {
+    const auto sctp(co_await Post([&]() -> rtc::scoped_refptr<webrtc::SctpTransportInterface> {
+        return (*peer_)->GetSctpTransport();
+    }));
+
+    orc_assert(sctp != nullptr);
+
+    auto &thread(peer_->origin_->Thread());
+    const auto bypass(co_await Post([&]() {
+        return new Bypass(*this, thread, sctp);
+    }, thread));
+
+    orc_insist(bypass_.exchange(bypass, std::memory_order_release) == nullptr);
+}
+
+void Channel::Release() noexcept {
+    dropped_ += queue_.size();
+    queue_.clear();
+
+    for (auto sending(waiting_); sending != nullptr; sending = sending->next_) {
+        sending->flow_ = 0;
+        ++dropped_;
+    }
+
+    Resume(waiting_);
+    waiting_ = nullptr;
+    tail_ = &waiting_;
+}
+
 class Actor final :
     public Peer
 {
@@ -53,11 +190,25 @@ orc_trace();
 };
 
 task<Socket> Channel::Wire(BufferSunk &sunk, S<Origin> origin, Configuration configuration, const std::function<task<std::string> (std::string)> &respond) {
+    co_return co_await Wire({&sunk}, std::move(origin), std::move(configuration), respond);
+}
+
+task<Socket> Channel::Wire(const std::vector<BufferSunk *> &sunks, S<Origin> origin, Configuration configuration, const std::function<task<std::string> (std::string)> &respond, bool bypass) {
     const auto client(Make<Actor>(std::move(origin), std::move(configuration)));
-    auto &channel(sunk.Wire<Channel>(client));
-    const auto answer(co_await respond(Strip(co_await client->Offer())));
+    // every channel has to exist before the offer is made to be in it
+    std::vector<Channel *> channels;
+    for (const auto sunk : sunks)
+        channels.emplace_back(&sunk->Wire<Channel>(client));
+    auto offer(Strip(co_await client->Offer()));
+    if (bypass)
+        offer = Propose(std::move(offer), "bypass");
+    const auto answer(co_await respond(std::move(offer)));
     co_await client->Negotiate(answer);
-    co_await channel.Open();
+    for (const auto channel : channels)
+        co_await channel->Open();
+    // a peer's channels all share one DTLS transport, so only one can bypass
+    if (bypass && Proposed(answer, "bypass") && !channels.empty())
+        co_await channels.front()->Raw();
     const auto candidate(co_await client->Candidate());
     const auto &socket(candidate.address());
     co_return Socket(socket.ipaddr().ipv4_address(), socket.port());
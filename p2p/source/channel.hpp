@@ -23,31 +23,111 @@
 #ifndef ORCHID_CHANNEL_HPP
 #define ORCHID_CHANNEL_HPP
 
+#include <deque>
 #include <functional>
+#include <vector>
 
+#include "bypass.hpp"
 #include "peer.hpp"
 
 namespace orc {
 
 class Socket;
 
+// what a Channel does with packets that SCTP can't take yet: they queue,
+// and past watermark_ the drop policy applies; once limit_ packets are
+// queued, senders wait (unless the policy already keeps it shorter)
+
+enum class Drop {
+    None,
+    Tail,
+    Head,
+    Delay,
+};
+
+struct Flow {
+    // SCTP's buffered_amount(): stop feeding it at high_, resume at low_
+    uint64_t high_ = 1024 * 1024;
+    uint64_t low_ = 256 * 1024;
+
+    size_t watermark_ = 64;
+    size_t limit_ = 256;
+    Drop drop_ = Drop::Delay;
+
+    // for Drop::Delay (CoDel): how long packets may stand in the queue
+    uint64_t target_ = 5000000;
+    uint64_t interval_ = 100000000;
+};
+
+// this sets the default for every Channel made afterwards
+void Flows(const Flow &flow);
+Flow Flows();
+
 class Channel :
     public Pump<Buffer>,
     public webrtc::DataChannelObserver
 {
+    friend class Bypass;
+
   private:
     const S<Peer> peer_;
     const rtc::scoped_refptr<webrtc::DataChannelInterface> channel_;
 
     Event opened_;
 
+    class Sending :
+        public Job
+    {
+      public:
+        Channel &channel_;
+        rtc::CopyOnWriteBuffer buffer_;
+
+        Sending(Channel &channel, rtc::CopyOnWriteBuffer buffer) :
+            Job(*Threads::Get().batch_, Priority::Data),
+            channel_(channel),
+            buffer_(std::move(buffer))
+        {
+        }
+
+        bool Run() noexcept override {
+            return channel_.Queue(this);
+        }
+    };
+
+    struct Queued {
+        rtc::CopyOnWriteBuffer buffer_;
+        uint64_t stamp_;
+    };
+
+    // everything below is only touched on the signaling thread
+    const Flow flow_;
+    std::deque<Queued> queue_;
+    Stacked *waiting_ = nullptr;
+    Stacked **tail_ = &waiting_;
+
+    uint64_t above_ = 0;
+    uint64_t again_ = 0;
+    unsigned drops_ = 0;
+    uint64_t dropped_ = 0;
+
+    // set by Raw(), and only deleted (on the network thread) with this
+    std::atomic<Bypass *> bypass_ = nullptr;
+
+    bool Queue(Sending *sending) noexcept;
+    bool Delay(uint64_t sojourn, uint64_t now) noexcept;
+    void Drain() noexcept;
+    void Release() noexcept;
+
   public:
     static task<Socket> Wire(BufferSunk &sunk, S<Origin> origin, Configuration configuration, const std::function<task<std::string> (std::string)> &respond);
+    // with bypass, the offer proposes bypassing SCTP; if the answer agrees, the first channel is Raw()
+    static task<Socket> Wire(const std::vector<BufferSunk *> &sunks, S<Origin> origin, Configuration configuration, const std::function<task<std::string> (std::string)> &respond, bool bypass = false);
 
-    Channel(BufferDrain &drain, const S<Peer> &peer, const rtc::scoped_refptr<webrtc::DataChannelInterface> &channel) :
+    Channel(BufferDrain &drain, const S<Peer> &peer, const rtc::scoped_refptr<webrtc::DataChannelInterface> &channel, const Flow &flow = Flows()) :
         Pump<Buffer>(drain),
         peer_(peer),
-        channel_(channel)
+        channel_(channel),
+        flow_(flow)
     {
         type_ = typeid(*this).name();
         channel_->RegisterObserver(this);
@@ -70,6 +150,10 @@ class Channel :
 
     ~Channel() override {
 orc_trace();
+        if (const auto bypass = bypass_.load())
+            peer_->origin_->Thread().Invoke<void>(RTC_FROM_HERE, [&]() {
+                delete bypass;
+            });
         peer_->channels_.erase(this);
         channel_->UnregisterObserver();
     }
@@ -94,16 +178,17 @@ orc_trace();
                     Log() << "OnStateChange(kClosing)" << std::endl;
                 break;
             case webrtc::DataChannelInterface::kClosed:
+                Release();
                 if (Verbose)
-                    Log() << "OnStateChange(kClosed)" << std::endl;
+                    Log() << "OnStateChange(kClosed) dropped " << std::dec << dropped_ << std::endl;
                 Stop();
                 break;
         }
     }
 
     void OnBufferedAmountChange(uint64_t previous) noexcept override {
-        //auto current(channel_->buffered_amount());
-        //Log() << "channel: " << current << " (" << previous << ")" << std::endl;
+        if (!queue_.empty() && channel_->buffered_amount() <= flow_.low_)
+            Drain();
     }
 
     void OnMessage(const webrtc::DataBuffer &buffer) noexcept override {
@@ -121,6 +206,16 @@ orc_trace();
         co_await *opened_;
     }
 
+    // once open: send packets as raw DTLS datagrams (see Bypass); the other
+    // side has to do this too, as negotiated with Propose("bypass"), and only one
+    // channel on a peer can, as they all share its one DTLS transport
+    task<void> Raw();
+
+    bool Bypassed() const noexcept {
+        const auto bypass(bypass_.load(std::memory_order_acquire));
+        return bypass != nullptr && bypass->Ready();
+    }
+
     task<void> Shut() noexcept override {
         channel_->Close();
         // XXX: this should be checking if Peer has a data_transport
@@ -130,13 +225,14 @@ orc_trace();
     }
 
     task<void> Send(const Buffer &data) override {
+        if (Bypassed())
+            co_return co_await bypass_.load(std::memory_order_relaxed)->Send(data);
         //Log() << "WebRTC <<< " << this << " " << data << std::endl;
         rtc::CopyOnWriteBuffer buffer(data.size());
         data.copy(buffer.data(), buffer.size());
-        co_await Post([&]() {
-            if (channel_->buffered_amount() == 0)
-                channel_->Send(webrtc::DataBuffer(buffer, true));
-        });
+        // this only waits if the queue is full and the policy is to push back
+        Sending sending(*this, std::move(buffer));
+        co_await sending;
     }
 };
 
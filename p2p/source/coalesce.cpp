@@ -0,0 +1,160 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include "bench.hpp"
+#include "coalesce.hpp"
+#include "sleep.hpp"
+
+namespace orc {
+
+static Coalescing coalescings_;
+
+void Coalescings(const Coalescing &coalescing) {
+    coalescings_ = coalescing;
+}
+
+Coalescing Coalescings() {
+    return coalescings_;
+}
+
+// how much of this is its first packet, going by that packet's header
+static size_t Packet(const uint8_t *data, size_t size) {
+    size_t length(size);
+    if (size >= 20 && data[0] >> 4 == 4)
+        length = size_t(data[2]) << 8 | data[3];
+    else if (size >= 40 && data[0] >> 4 == 6)
+        length = 40 + (size_t(data[4]) << 8 | data[5]);
+    // anything that isn't IP, or that doesn't fit, is taken to be the rest
+    return length < 20 || length > size ? size : length;
+}
+
+void Coalesce::Land(const Buffer &data) {
+    const auto split([&](const uint8_t *data, size_t size) {
+        while (size != 0) {
+            const auto length(Packet(data, size));
+            Link::Land(Subset(data, length));
+            data += length;
+            size -= length;
+        }
+    });
+
+    // what Channel lands is a single Subset, but a Buffer need not be
+    const uint8_t *base(nullptr);
+    size_t size(0);
+    unsigned regions(0);
+    data.each([&](const uint8_t *data, size_t writ) {
+        base = data;
+        size = writ;
+        return ++regions == 1;
+    });
+
+    if (regions <= 1)
+        split(base, size);
+    else {
+        const Beam beam(data);
+        split(beam.data(), beam.size());
+    }
+}
+
+// the Wheel ticks every 10ms, so a shorter delay can't sleep on it
+static const unsigned Tick(10000);
+// ...and instead yields to the pool, at most this many times, so that an
+// idle frame can't keep a worker spinning for the whole delay
+static const unsigned Yields(16);
+
+task<void> Coalesce::Flush(uint64_t serial) {
+    if (coalescing_.delay_ >= Tick)
+        co_await Sleep(coalescing_.delay_ / 1000);
+    else {
+        // each yield goes behind (and so after) any senders that might add to it
+        const auto deadline(Bench::Now() + uint64_t(coalescing_.delay_) * 1000);
+        for (unsigned i(0); i != Yields && serial_.load(std::memory_order_relaxed) == serial; ++i) {
+            co_await Schedule();
+            if (Bench::Now() >= deadline)
+                break;
+        }
+    }
+
+    std::vector<uint8_t> frame;
+    { const auto locked(locked_());
+        // a sender filled it, and sent it already
+        if (serial_.load(std::memory_order_relaxed) != serial)
+            co_return;
+        frame.swap(locked->frame_);
+        ++serial_; }
+
+    co_await Inner().Send(Subset(frame.data(), frame.size()));
+}
+
+task<void> Coalesce::Shut() noexcept {
+    co_await nest_.Shut();
+    co_await Sunken::Shut();
+    co_await Link::Shut();
+}
+
+task<void> Coalesce::Send(const Buffer &data) {
+    const auto size(data.size());
+    if (!engaged_.load(std::memory_order_acquire))
+        co_return co_await Inner().Send(data);
+
+    if (size >= coalescing_.size_) {
+        // what is waiting to be packed was sent first, so it has to go first
+        std::vector<uint8_t> pending;
+        { const auto locked(locked_());
+            if (!locked->frame_.empty()) {
+                pending.swap(locked->frame_);
+                ++serial_;
+            } }
+        if (!pending.empty())
+            co_await Inner().Send(Subset(pending.data(), pending.size()));
+        co_return co_await Inner().Send(data);
+    }
+
+    std::vector<uint8_t> full;
+    uint64_t serial;
+    bool first;
+
+    { const auto locked(locked_());
+        auto &frame(locked->frame_);
+        // this doesn't fit: send what is there, and start the next frame
+        if (frame.size() + size > coalescing_.size_) {
+            full.swap(frame);
+            ++serial_;
+        }
+        serial = serial_.load(std::memory_order_relaxed);
+        first = frame.empty();
+        const auto offset(frame.size());
+        frame.resize(offset + size);
+        data.copy(frame.data() + offset, size);
+    }
+
+    if (first)
+        nest_.Hatch([&]() noexcept { return [this, serial]() -> task<void> {
+            co_await Flush(serial);
+        }; }, __FUNCTION__, Priority::Data);
+
+    // whoever fills a frame sends it, which pushes back on busy senders
+    if (!full.empty())
+        co_await Inner().Send(Subset(full.data(), full.size()));
+}
+
+}
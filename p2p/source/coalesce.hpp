@@ -0,0 +1,98 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#ifndef ORCHID_COALESCE_HPP
+#define ORCHID_COALESCE_HPP
+
+#include <atomic>
+#include <vector>
+
+#include "link.hpp"
+#include "locked.hpp"
+#include "nest.hpp"
+
+namespace orc {
+
+struct Coalescing {
+    // packets smaller than this are packed into messages of up to this
+    // size (0 turns this off, and refuses a client that proposes it)...
+    size_t size_ = 1200;
+    // ...which are sent once full, or when their first packet has waited
+    // this many microseconds (below 10ms, at most a few trips through the
+    // pool, so possibly less)
+    unsigned delay_ = 100;
+};
+
+// this sets the default for every Coalesce made afterwards, and whether
+// Clients propose "coalesce" and Servers agree to it
+void Coalescings(const Coalescing &coalescing);
+Coalescing Coalescings();
+
+// Coalesce sits between a Bonding and its Channel, packing small IP packets
+// into one message so interactive and ACK traffic doesn't pay for SCTP,
+// DTLS and a Post() each. The packets are simply concatenated: their own
+// headers delimit them, which also means a message with one packet in it
+// is the same as it would have been without this; and so, as it is always
+// safe to split what arrives, only sending waits for Engage() (once both
+// sides agreed). Billing happens above this, so it still counts packets.
+
+class Coalesce :
+    public Link<Buffer>,
+    public Sunken<Pump<Buffer>>
+{
+  private:
+    const Coalescing coalescing_;
+    std::atomic<bool> engaged_ = false;
+
+    struct Locked_ {
+        std::vector<uint8_t> frame_;
+    }; Locked<Locked_> locked_;
+
+    // which frame is being filled; changed under the lock as one is sent
+    std::atomic<uint64_t> serial_ = 0;
+
+    Nest nest_;
+
+    task<void> Flush(uint64_t serial);
+
+  protected:
+    void Land(const Buffer &data) override;
+
+  public:
+    Coalesce(BufferDrain &drain, const Coalescing &coalescing = Coalescings()) :
+        Link<Buffer>(drain),
+        coalescing_(coalescing)
+    {
+        type_ = typeid(*this).name();
+    }
+
+    void Engage() noexcept {
+        engaged_.store(coalescing_.size_ != 0, std::memory_order_release);
+    }
+
+    task<void> Shut() noexcept override;
+    task<void> Send(const Buffer &data) override;
+};
+
+}
+
+#endif//ORCHID_COALESCE_HPP
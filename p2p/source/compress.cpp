@@ -0,0 +1,156 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+// LZ4_attach_dictionary is only exposed this way
+#define LZ4_STATIC_LINKING_ONLY
+#include <lz4.h>
+
+#include "compress.hpp"
+
+namespace orc {
+
+static Compression compressions_;
+
+void Compressions(const Compression &compression) {
+    compressions_ = compression;
+}
+
+Compression Compressions() {
+    return compressions_;
+}
+
+// an IPv4 header can't be shorter than five words, so this can't be a packet
+static const uint8_t Marker_(0x41);
+// the marker, and then the original size (an IP packet fits in 16 bits)
+static const size_t Header_(3);
+// below this, there's rarely a repeat for LZ4 to find (these are mostly ACKs)
+static const size_t Minimum_(64);
+
+// a lone packet rarely repeats itself, but what it says is often said by
+// every other one; both sides must have the same dictionary, so changing it
+// will need a new feature name (beyond "compress") to negotiate the change
+static const char Dictionary_[] =
+    "\x03www\x03""com\x00\x00\x01\x00\x01\x00\x00\x1c\x00\x01\x03""net\x00\x03org\x00"
+    "HTTP/1.1 200 OK\r\nDate: \r\nServer: \r\nContent-Type: text/html; charset=utf-8\r\n"
+    "Content-Length: \r\nCache-Control: no-cache, max-age=\r\nLast-Modified: \r\nETag: \"\r\n"
+    "Set-Cookie: \r\nLocation: http://\r\nTransfer-Encoding: chunked\r\nContent-Encoding: gzip\r\n"
+    "GET / HTTP/1.1\r\nPOST /\r\nHost: www.\r\nConnection: keep-alive\r\nAccept: */*\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\nAccept-Language: en-US,en;q=0.9\r\n"
+    "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/\r\n"
+    "Referer: https://www.\r\nCookie: \r\n";
+
+// loading a dictionary hashes all of it, so each thread does that once, and
+// then attaches it (which is cheap) to a stream that is reset per message
+class Dictionary {
+  private:
+    LZ4_stream_t stream_;
+
+  public:
+    Dictionary() {
+        LZ4_initStream(&stream_, sizeof(stream_));
+        LZ4_loadDict(&stream_, Dictionary_, sizeof(Dictionary_) - 1);
+    }
+
+    operator const LZ4_stream_t *() const {
+        return &stream_;
+    }
+};
+
+// what Channel lands is a single Subset, but a Buffer need not be
+template <typename Code_>
+static void Flat(const Buffer &data, Code_ &&code) {
+    const uint8_t *base(nullptr);
+    size_t size(0);
+    unsigned regions(0);
+    data.each([&](const uint8_t *data, size_t writ) {
+        base = data;
+        size = writ;
+        return ++regions == 1;
+    });
+
+    if (regions <= 1)
+        code(base, size);
+    else {
+        const Beam beam(data);
+        code(beam.data(), beam.size());
+    }
+}
+
+void Compress::Land(const Buffer &data) {
+    Flat(data, [&](const uint8_t *data, size_t size) {
+        if (size < Header_ || data[0] != Marker_)
+            return Link::Land(Subset(data, size));
+
+        const size_t original(size_t(data[1]) << 8 | data[2]);
+        // Send() never makes one of these that isn't smaller than what it
+        // holds, and refunding the difference would then wrap around
+        if (size >= original)
+            return;
+
+        Beam beam(original);
+        const auto writ(LZ4_decompress_safe_usingDict(reinterpret_cast<const char *>(data + Header_), reinterpret_cast<char *>(beam.data()), int(size - Header_), int(original), Dictionary_, sizeof(Dictionary_) - 1));
+        // this is dropped, as a packet that was damaged in transit would be
+        if (writ < 0 || size_t(writ) != original)
+            return;
+
+        if (refund_ != nullptr)
+            refund_(original - size);
+        Link::Land(beam);
+    });
+}
+
+task<void> Compress::Shut() noexcept {
+    co_await Sunken::Shut();
+    co_await Link::Shut();
+}
+
+task<void> Compress::Send(const Buffer &data) {
+    const auto size(data.size());
+    if (!engaged_.load(std::memory_order_acquire) || size < Minimum_ || size > 0xffff)
+        co_return co_await Inner().Send(data);
+
+    // LZ4 gives up once it runs out of room, so incompressible data (such as
+    // TLS) costs little: it only has to save more than the header to be used
+    Beam frame(size - 1);
+    int writ(0);
+    Flat(data, [&](const uint8_t *data, size_t size) {
+        // LZ4 only takes a dictionary through a stream
+        thread_local const Dictionary dictionary;
+        thread_local LZ4_stream_t stream;
+        LZ4_resetStream_fast(&stream);
+        LZ4_attach_dictionary(&stream, dictionary);
+        writ = LZ4_compress_fast_continue(&stream, reinterpret_cast<const char *>(data), reinterpret_cast<char *>(frame.data() + Header_), int(size), int(frame.size() - Header_), acceleration_);
+    });
+
+    if (writ <= 0)
+        co_return co_await Inner().Send(data);
+
+    frame[0] = Marker_;
+    frame[1] = uint8_t(size >> 8);
+    frame[2] = uint8_t(size);
+
+    if (refund_ != nullptr)
+        refund_(size - Header_ - writ);
+    co_await Inner().Send(frame.subset(0, Header_ + writ));
+}
+
+}
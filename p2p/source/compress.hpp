@@ -0,0 +1,92 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+
+#ifndef ORCHID_COMPRESS_HPP
+#define ORCHID_COMPRESS_HPP
+
+#include <atomic>
+#include <functional>
+
+#include "link.hpp"
+
+namespace orc {
+
+struct Compression {
+    // LZ4's acceleration: higher is faster, and compresses less (0 turns
+    // this off, and refuses a client that proposes it)
+    int acceleration_ = 0;
+    // a Server bills (and tells its Clients to bill) the bytes that crossed
+    // the wire, rather than those of the packets they carried
+    bool wire_ = false;
+};
+
+// this sets the default for every Compress made afterwards, whether Clients
+// propose "compress" and whether Servers agree to it (and "compress-wire")
+void Compressions(const Compression &compression);
+Compression Compressions();
+
+// Compress sits between a Bonding and its Channel (beneath any Coalesce, so
+// it sees whole frames), running each message through LZ4 on its own (but
+// primed with a dictionary of what packets often say, see compress.cpp). What
+// doesn't get smaller is sent as it was; what does is marked by a byte that
+// no IP packet begins with (but which still looks like IP to a Bypass), then
+// its original size. As with Coalesce, it is always safe to expand what
+// arrives, so only sending waits for Engage(); which, when billing is of the
+// wire, also takes where to refund the bytes saved, as that happens above.
+
+class Compress :
+    public Link<Buffer>,
+    public Sunken<Pump<Buffer>>
+{
+  public:
+    typedef std::function<void (size_t)> Refund;
+
+  private:
+    const int acceleration_;
+    std::atomic<bool> engaged_ = false;
+    // set before anything is sent or arrives, and then only read
+    Refund refund_;
+
+  protected:
+    void Land(const Buffer &data) override;
+
+  public:
+    Compress(BufferDrain &drain, const Compression &compression = Compressions()) :
+        Link<Buffer>(drain),
+        acceleration_(compression.acceleration_)
+    {
+        type_ = typeid(*this).name();
+    }
+
+    void Engage(Refund refund = nullptr) noexcept {
+        refund_ = std::move(refund);
+        engaged_.store(acceleration_ != 0, std::memory_order_release);
+    }
+
+    task<void> Shut() noexcept override;
+    task<void> Send(const Buffer &data) override;
+};
+
+}
+
+#endif//ORCHID_COMPRESS_HPP
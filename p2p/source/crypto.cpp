@@ -25,13 +25,12 @@
 #include <boost/random.hpp>
 #include <boost/random/random_device.hpp>
 
-#include <ethash/keccak.hpp>
-
 #include <secp256k1.h>
 #include <secp256k1_ecdh.h>
 #include <secp256k1_recovery.h>
 
 #include "crypto.hpp"
+#include "keccak.hpp"
 
 namespace orc {
 
@@ -45,11 +44,9 @@ void Random(uint8_t *data, size_t size) {
 }
 
 Brick<32> Hash(const Buffer &data) {
-    Beam beam(data);
-    const auto hash(ethash_keccak256(beam.data(), beam.size()));
-    Brick<sizeof(hash)> value;
-    memcpy(value.data(), hash.bytes, sizeof(hash));
-    return value;
+    Keccak keccak;
+    keccak += data;
+    return keccak.Finish();
 }
 
 Brick<32> Hash(const std::string &data) {
@@ -42,6 +42,9 @@ bool Datagram(const Buffer &data, const std::function<bool (const Socket &, cons
 
     if (ip4.protocol != uint8_t(openvpn::IPCommon::UDP))
         return false;
+    // a fragment isn't a whole datagram (MF, or an offset)
+    if ((boost::endian::big_to_native(ip4.frag_off) & 0x3fff) != 0)
+        return false;
 
     openvpn::UDPHeader udp;
     window.Take(&udp);
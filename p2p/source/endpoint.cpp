@@ -22,50 +22,14 @@
 
 #include <regex>
 
+#include "bench.hpp"
 #include "endpoint.hpp"
 #include "error.hpp"
 #include "json.hpp"
+#include "lazy.hpp"
 
 namespace orc {
 
-static Nested Verify(const Json::Value &proofs, Brick<32> hash, const Region &path) {
-    size_t offset(0);
-    orc_assert(!proofs.isNull());
-    for (auto e(proofs.size()), i(decltype(e)(0)); i != e; ++i) {
-        const auto data(Bless(proofs[i].asString()));
-        orc_assert(Hash(data) == hash);
-
-        const auto proof(Explode(data));
-        switch (proof.size()) {
-            case 17: {
-                if (offset == path.size() * 2)
-                    return Explode(proof[16].buf());
-                const auto data(proof[path.nib(offset++)].buf());
-                if (data.size() == 0)
-                    return Nested();
-                hash = data;
-            } break;
-
-            case 2: {
-                const auto leg(proof[0].buf());
-                const auto type(leg.nib(0));
-                for (size_t i((type & 0x1) != 0 ? 1 : 2), e(leg.size() * 2); i != e; ++i)
-                    if (path.nib(offset++) != leg.nib(i))
-                        return Nested();
-                const Range range(proof[1].buf());
-                if ((type & 0x2) != 0)
-                    return Explode(range);
-                hash = range;
-            } break;
-
-            default:
-                orc_assert(false);
-        }
-    }
-
-    orc_assert(false);
-}
-
 Block::Block(Json::Value &&value) :
     number_(value["number"].asString()),
     state_(value["stateRoot"].asString()),
@@ -73,13 +37,13 @@ Block::Block(Json::Value &&value) :
 {
 }
 
-Account::Account(const Block &block, const Json::Value &value) :
+Account::Account(const Block &block, const Json::Value &value, const Proof &proof) :
     nonce_(value["nonce"].asString()),
     balance_(value["balance"].asString()),
     storage_(value["storageHash"].asString()),
     code_(value["codeHash"].asString())
 {
-    const auto leaf(Verify(value["accountProof"], Number<uint256_t>(block.state_), Hash(Number<uint160_t>(value["address"].asString()))));
+    const auto leaf(proof.Verify(Number<uint256_t>(block.state_), Hash(Number<uint160_t>(value["address"].asString()))));
     orc_assert(leaf.size() == 4);
     orc_assert(leaf[0].num() == nonce_);
     orc_assert(leaf[1].num() == balance_);
@@ -87,11 +51,11 @@ Account::Account(const Block &block, const Json::Value &value) :
     orc_assert(leaf[3].num() == code_);
 }
 
-uint256_t Endpoint::Get(int index, const Json::Value &storages, const Region &root, const uint256_t &key) const {
+uint256_t Endpoint::Get(int index, const Json::Value &storages, const Proof &proof, const Region &root, const uint256_t &key) const {
     const auto storage(storages[index]);
     orc_assert(uint256_t(storage["key"].asString()) == key);
     const uint256_t value(storage["value"].asString());
-    const auto leaf(Verify(storage["proof"], root, Hash(Number<uint256_t>(key))));
+    const auto leaf(proof.Verify(root, Hash(Number<uint256_t>(key))));
     orc_assert(leaf.num() == value);
     return value;
 }
@@ -105,7 +69,10 @@ static Brick<32> Name(const std::string &name) {
     return Hash(Tie(Name(name.substr(period + 1)), Hash(name.substr(0, period))));
 }
 
+static Histogram rpc_("rpc");
+
 task<Json::Value> Endpoint::operator ()(const std::string &method, Argument args) const {
+    Bench bench(rpc_);
     Json::FastWriter writer;
 
     const auto body(writer.write([&]() {
@@ -117,13 +84,17 @@ task<Json::Value> Endpoint::operator ()(const std::string &method, Argument args
         return root;
     }()));
 
-    const auto data(Parse((co_await origin_->Fetch("POST", locator_, {{"content-type", "application/json"}}, body)).ok()));
-    Log() << body << " -> " << data << "" << std::endl;
+    const auto response((co_await origin_->Fetch("POST", locator_, {{"content-type", "application/json"}}, body)).ok());
+    orc_Level(Debug) << body << " -> " << response << "" << std::endl;
+
+    // only the result is ever turned into a Json::Value; the envelope is read in place
+    const Index index(response);
+    const auto data(*index);
     orc_assert(data["jsonrpc"] == "2.0");
 
     const auto error(data["error"]);
     if (!error.isNull()) {
-        auto text(writer.write(error));
+        auto text(writer.write(error.json()));
         orc_assert(!text.empty());
         orc_assert(text[text.size() - 1] == '\n');
         text.resize(text.size() - 1);
@@ -133,7 +104,7 @@ task<Json::Value> Endpoint::operator ()(const std::string &method, Argument args
     const auto id(data["id"]);
     orc_assert(!id.isNull());
     orc_assert(id == "");
-    co_return data["result"];
+    co_return data["result"].json();
 }
 
 task<uint256_t> Endpoint::Latest() const {
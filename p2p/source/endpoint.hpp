@@ -27,6 +27,7 @@
 #include "jsonrpc.hpp"
 #include "locator.hpp"
 #include "origin.hpp"
+#include "proof.hpp"
 
 namespace orc {
 
@@ -44,7 +45,7 @@ struct Account final {
     const uint256_t storage_;
     const uint256_t code_;
 
-    Account(const Block &block, const Json::Value &value);
+    Account(const Block &block, const Json::Value &value, const Proof &proof);
 };
 
 class Endpoint final {
@@ -57,16 +58,16 @@ class Endpoint final {
     const S<Origin> origin_;
     const Locator locator_;
 
-    uint256_t Get(int index, const Json::Value &storages, const Region &root, const uint256_t &key) const;
+    uint256_t Get(int index, const Json::Value &storages, const Proof &proof, const Region &root, const uint256_t &key) const;
 
     template <int Offset_, int Index_, typename Result_, typename... Args_>
-    void Get(Result_ &result, const Json::Value &storages, const Region &root) const {
+    void Get(Result_ &result, const Json::Value &storages, const Proof &proof, const Region &root) const {
     }
 
     template <int Offset_, int Index_, typename Result_, typename... Args_>
-    void Get(Result_ &result, const Json::Value &storages, const Region &root, const uint256_t &key, Args_ &&...args) const {
-        std::get<Offset_ + Index_>(result) = Get(Index_, storages, root, key);
-        Get<Offset_, Index_ + 1>(result, storages, root, std::forward<Args_>(args)...);
+    void Get(Result_ &result, const Json::Value &storages, const Proof &proof, const Region &root, const uint256_t &key, Args_ &&...args) const {
+        std::get<Offset_ + Index_>(result) = Get(Index_, storages, proof, root, key);
+        Get<Offset_, Index_ + 1>(result, storages, proof, root, std::forward<Args_>(args)...);
     }
 
   public:
@@ -89,30 +90,33 @@ class Endpoint final {
     template <typename... Args_>
     task<std::tuple<Account, typename Result_<Args_>::type...>> Get(const Block &block, const Address &contract, std::nullptr_t, Args_ &&...args) const {
         const auto proof(co_await operator ()("eth_getProof", {contract, {std::forward<Args_>(args)...}, block.number_}));
-        std::tuple<Account, typename Result_<Args_>::type...> result(Account(block, proof));
+        const Proof nodes(proof);
+        std::tuple<Account, typename Result_<Args_>::type...> result(Account(block, proof, nodes));
         Number<uint256_t> root(proof["storageHash"].asString());
-        Get<1, 0>(result, proof["storageProof"], root, std::forward<Args_>(args)...);
+        Get<1, 0>(result, proof["storageProof"], nodes, root, std::forward<Args_>(args)...);
         co_return result;
     }
 
     template <typename... Args_>
     task<std::tuple<typename Result_<Args_>::type...>> Get(const Block &block, const Address &contract, const uint256_t &storage, Args_ &&...args) const {
         const auto proof(co_await operator ()("eth_getProof", {contract, {std::forward<Args_>(args)...}, block.number_}));
+        const Proof nodes(proof);
         std::tuple<typename Result_<Args_>::type...> result;
         Number<uint256_t> root(proof["storageHash"].asString());
         orc_assert(storage == root.num<uint256_t>());
-        Get<0, 0>(result, proof["storageProof"], root, std::forward<Args_>(args)...);
+        Get<0, 0>(result, proof["storageProof"], nodes, root, std::forward<Args_>(args)...);
         co_return result;
     }
 
     template <typename... Args_>
     task<std::tuple<Account, std::vector<uint256_t>>> Get(const Block &block, const Address &contract, const std::vector<uint256_t> &args) const {
         const auto proof(co_await operator ()("eth_getProof", {contract, {std::forward<Args_>(args)...}, block.number_}));
-        std::tuple<Account, std::vector<uint256_t>> result(Account(block, proof));
+        const Proof nodes(proof);
+        std::tuple<Account, std::vector<uint256_t>> result(Account(block, proof, nodes));
         Number<uint256_t> root(proof["storageHash"].asString());
         auto storages(proof["storageProof"]);
         for (unsigned i(0); i != args.size(); ++i)
-            std::get<1>(result).emplace_back(Get(i, storages, root, args[i]));
+            std::get<1>(result).emplace_back(Get(i, storages, nodes, root, args[i]));
         co_return result;
     }
 };
@@ -56,7 +56,7 @@ class Error final :
 
 #define orc_insist_(code, text) do { \
     if ((code)) break; \
-    orc_log(orc_Log(), text << std::endl); \
+    orc_log(orc::Log(orc_fiber, orc::Level::Fatal), text << std::endl); \
     std::terminate(); \
 } while (false)
 
@@ -99,7 +99,7 @@ class Error final :
 
 #define orc_except(code) \
     try code catch (...) { \
-        orc_log(orc_Log(), "orc_except(" #code ")" << std::endl); \
+        orc_log(orc::Log(orc_fiber, orc::Level::Fatal), "orc_except(" #code ")" << std::endl); \
         std::terminate(); \
     }
 
@@ -0,0 +1,198 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "frame.hpp"
+
+namespace orc {
+
+static std::atomic<uint64_t> allocated_(0);
+static std::atomic<uint64_t> released_(0);
+
+namespace {
+
+static const size_t Granule = 64;
+static const size_t Buckets = 64;
+static const size_t Depth = 256;
+static const size_t Batch = 64;
+// how many Batches the Depot keeps per bucket, before handing them back
+static const size_t Batches = 64;
+
+struct Free {
+    Free *next_;
+};
+
+void *Allocate(size_t size) {
+    allocated_.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+}
+
+void Release(void *data) noexcept {
+    released_.fetch_add(1, std::memory_order_relaxed);
+    ::operator delete(data);
+}
+
+void Release(Free *free) noexcept {
+    while (free != nullptr) {
+        const auto next(free->next_);
+        Release(static_cast<void *>(free));
+        free = next;
+    }
+}
+
+// a frame can be freed into any thread's Cache, so anything that fits in a
+// bucket must come from the heap at that bucket's size, even bypassing it
+size_t Round(size_t size) {
+    const auto bucket((size - 1) / Granule);
+    return bucket < Buckets ? (bucket + 1) * Granule : size;
+}
+
+// Depot moves frames between threads in batches: coroutines are often made on
+// one thread (asio, WebRTC) and destroyed on another (the Pool's workers)
+
+class Depot {
+  private:
+    std::mutex mutex_;
+    std::vector<Free *> batches_[Buckets];
+
+    Depot() {
+        for (auto &batches : batches_)
+            batches.reserve(Batches);
+    }
+
+  public:
+    static Depot &Get() {
+        // this is leaked on purpose, like Pool: frames are freed during exit
+        static const auto depot(new Depot());
+        return *depot;
+    }
+
+    void Push(size_t bucket, Free *batch) noexcept {
+        { std::unique_lock<std::mutex> lock(mutex_);
+            auto &batches(batches_[bucket]);
+            // this was reserved, so it never allocates (or throws)
+            if (batches.size() != Batches) {
+                batches.emplace_back(batch);
+                return;
+            } }
+        Release(batch);
+    }
+
+    Free *Pop(size_t bucket) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto &batches(batches_[bucket]);
+        if (batches.empty())
+            return nullptr;
+        const auto batch(batches.back());
+        batches.pop_back();
+        return batch;
+    }
+};
+
+class Cache {
+  private:
+    Free *frees_[Buckets] = {};
+    size_t counts_[Buckets] = {};
+
+  public:
+    // set once this thread's cache has been destroyed, as frames can still be
+    // freed by other thread_local destructors that run after it during exit
+    static thread_local bool dead_;
+
+    ~Cache() {
+        dead_ = true;
+        for (auto free : frees_)
+            Release(free);
+    }
+
+    void *New(size_t size) {
+        const auto bucket((size - 1) / Granule);
+        if (bucket >= Buckets)
+            return Allocate(size);
+
+        if (frees_[bucket] == nullptr) {
+            frees_[bucket] = Depot::Get().Pop(bucket);
+            if (frees_[bucket] == nullptr)
+                return Allocate(Round(size));
+            counts_[bucket] = Batch;
+        }
+
+        const auto free(frees_[bucket]);
+        frees_[bucket] = free->next_;
+        --counts_[bucket];
+        return free;
+    }
+
+    void Delete(void *data, size_t size) noexcept {
+        const auto bucket((size - 1) / Granule);
+        if (bucket >= Buckets)
+            return Release(data);
+
+        if (counts_[bucket] == Depth) {
+            const auto batch(frees_[bucket]);
+            auto last(batch);
+            for (size_t i(1); i != Batch; ++i)
+                last = last->next_;
+            frees_[bucket] = last->next_;
+            last->next_ = nullptr;
+            counts_[bucket] -= Batch;
+            Depot::Get().Push(bucket, batch);
+        }
+
+        const auto free(static_cast<Free *>(data));
+        free->next_ = frees_[bucket];
+        frees_[bucket] = free;
+        ++counts_[bucket];
+    }
+};
+
+thread_local bool Cache::dead_(false);
+thread_local Cache cache_;
+
+}
+
+void *Frames::New(size_t size) {
+    if (Cache::dead_)
+        return Allocate(Round(size));
+    return cache_.New(size);
+}
+
+void Frames::Delete(void *data, size_t size) noexcept {
+    if (Cache::dead_)
+        return Release(data);
+    cache_.Delete(data, size);
+}
+
+uint64_t Frames::Allocated() {
+    return allocated_.load(std::memory_order_relaxed);
+}
+
+uint64_t Frames::Released() {
+    return released_.load(std::memory_order_relaxed);
+}
+
+}
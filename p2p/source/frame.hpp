@@ -0,0 +1,47 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+
+#ifndef ORCHID_FRAME_HPP
+#define ORCHID_FRAME_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace orc {
+
+// Frames recycles coroutine frames through per-thread free lists bucketed by
+// size; a frame freed on another thread joins that thread's list instead
+
+class Frames {
+  public:
+    static void *New(size_t size);
+    static void Delete(void *data, size_t size) noexcept;
+
+    // the number of frames that had to come from (and went back to) the heap
+    static uint64_t Allocated();
+    static uint64_t Released();
+};
+
+}
+
+#endif//ORCHID_FRAME_HPP
@@ -287,7 +287,8 @@ struct Numeric<false, Size_, Type_> {
         return brick.template num<Type_>();
     }
 
-    static void Encode(Builder &builder, const Type_ &value) {
+    template <typename Builder_>
+    static void Encode(Builder_ &builder, const Type_ &value) {
         builder += Number<uint256_t>(value);
     }
 
@@ -307,7 +308,8 @@ struct Numeric<true, Size_, Type_> {
         return brick.template num<uint256_t>().convert_to<Type_>();
     }
 
-    static void Encode(Builder &builder, const Type_ &value) {
+    template <typename Builder_>
+    static void Encode(Builder_ &builder, const Type_ &value) {
         builder += Number<uint256_t>(value, signbit(value) ? 0xff : 0x00);
     }
 
@@ -364,7 +366,8 @@ struct Coded<Address, void> {
         return Coded<uint160_t>::Decode(window);
     }
 
-    static void Encode(Builder &builder, const Address &value) {
+    template <typename Builder_>
+    static void Encode(Builder_ &builder, const Address &value) {
         return Coded<uint160_t>::Encode(builder, value);
     }
 
@@ -389,7 +392,8 @@ struct Coded<bool, void> {
         return true;
     }
 
-    static void Encode(Builder &builder, const bool &value) {
+    template <typename Builder_>
+    static void Encode(Builder_ &builder, const bool &value) {
         return Coded<uint8_t>::Encode(builder, value ? 1 : 0);
     }
 
@@ -412,7 +416,8 @@ struct Coded<Brick<Size_>, typename std::enable_if<Size_ == 32>::type> {
         return value;
     }
 
-    static void Encode(Builder &builder, const Brick<Size_> &data) {
+    template <typename Builder_>
+    static void Encode(Builder_ &builder, const Brick<Size_> &data) {
         builder += data;
     }
 
@@ -440,7 +445,8 @@ struct Coded<Beam, void> {
         return data;
     }
 
-    static void Encode(Builder &builder, const Buffer &data) {
+    template <typename Builder_>
+    static void Encode(Builder_ &builder, const Buffer &data) {
         auto size(data.size());
         Coded<uint256_t>::Encode(builder, size);
         builder += data;
@@ -453,6 +459,24 @@ struct Coded<Beam, void> {
     }
 };
 
+// the view points into the window, which must be contiguous and outlive it
+template <>
+struct Coded<Range, void> :
+    public Coded<Beam, void>
+{
+    static Range Decode(Window &window) {
+        const auto size(Coded<uint256_t>::Decode(window).convert_to<size_t>());
+        Range range = Nothing();
+        window.Take(size, [&](const uint8_t *data, size_t writ) {
+            orc_assert_(writ == size, "bytes are not contiguous");
+            range = Range(data, size);
+            return writ;
+        });
+        window.Zero(Pad(size));
+        return range;
+    }
+};
+
 template <>
 struct Coded<std::string, void> {
     static const bool dynamic_ = true;
@@ -474,7 +498,8 @@ struct Coded<std::string, void> {
         return data;
     }
 
-    static void Encode(Builder &builder, const std::string &data) {
+    template <typename Builder_>
+    static void Encode(Builder_ &builder, const std::string &data) {
         auto size(data.size());
         Coded<uint256_t>::Encode(builder, size);
         builder += Subset(data);
@@ -502,7 +527,8 @@ struct Coded<std::vector<Type_>, void> {
         return {};
     }
 
-    static void Encode(Builder &builder, const std::vector<Type_> &values) {
+    template <typename Builder_>
+    static void Encode(Builder_ &builder, const std::vector<Type_> &values) {
         Coded<uint256_t>::Encode(builder, values.size());
         for (const auto &value : values)
             Coded<Type_>::Encode(builder, value);
@@ -528,12 +554,12 @@ struct Tupled<Index_> final {
     static void Tail(Window &window, Tuple_ &tuple) {
     }
 
-    template <typename Tuple_>
-    static void Head(Builder &builder, Tuple_ &tuple, size_t offset) {
+    template <typename Builder_, typename Tuple_>
+    static void Head(Builder_ &builder, Tuple_ &tuple, size_t offset) {
     }
 
-    template <typename Tuple_>
-    static void Tail(Builder &builder, Tuple_ &tuple) {
+    template <typename Builder_, typename Tuple_>
+    static void Tail(Builder_ &builder, Tuple_ &tuple) {
     }
 
     template <typename Tuple_>
@@ -559,8 +585,8 @@ struct Tupled<Index_, Next_, Rest_...> final {
         Tupled<Index_ + 1, Rest_...>::Tail(window, tuple);
     }
 
-    template <typename Tuple_>
-    static void Head(Builder &builder, Tuple_ &tuple, size_t offset) {
+    template <typename Builder_, typename Tuple_>
+    static void Head(Builder_ &builder, Tuple_ &tuple, size_t offset) {
         if (!Coded<Next_>::dynamic_)
             Coded<Next_>::Encode(builder, std::get<Index_>(tuple));
         else {
@@ -570,8 +596,8 @@ struct Tupled<Index_, Next_, Rest_...> final {
         Tupled<Index_ + 1, Rest_...>::Head(builder, tuple, offset);
     }
 
-    template <typename Tuple_>
-    static void Tail(Builder &builder, Tuple_ &tuple) {
+    template <typename Builder_, typename Tuple_>
+    static void Tail(Builder_ &builder, Tuple_ &tuple) {
         if (Coded<Next_>::dynamic_)
             Coded<Next_>::Encode(builder, std::get<Index_>(tuple));
         Tupled<Index_ + 1, Rest_...>::Tail(builder, tuple);
@@ -579,10 +605,8 @@ struct Tupled<Index_, Next_, Rest_...> final {
 
     template <typename Tuple_>
     static void Size(size_t &offset, Tuple_ &tuple) {
-        if (!Coded<Next_>::dynamic_)
+        if (Coded<Next_>::dynamic_)
             Coded<Next_>::Size(offset, std::get<Index_>(tuple));
-        else
-            offset += 32;
         Tupled<Index_ + 1, Rest_...>::Size(offset, tuple);
     }
 };
@@ -591,6 +615,9 @@ template <typename... Args_>
 struct Coded<std::tuple<Args_...>, void> {
     static const bool dynamic_ = true;
 
+    // every type Coded supports takes exactly one word of the head
+    static const size_t head_ = 32 * sizeof...(Args_);
+
     static std::tuple<Args_...> Decode(Window &window) {
         std::tuple<Args_...> value;
         Tupled<0, Args_...>::Head(window, value);
@@ -598,10 +625,16 @@ struct Coded<std::tuple<Args_...>, void> {
         return value;
     }
 
-    static void Encode(Builder &builder, const std::tuple<Args_...> &data) {
-        size_t offset(0);
+    template <typename Tuple_>
+    static size_t Size(const Tuple_ &data) {
+        size_t offset(head_);
         Tupled<0, Args_...>::Size(offset, data);
-        Tupled<0, Args_...>::Head(builder, data, offset);
+        return offset;
+    }
+
+    template <typename Builder_, typename Tuple_>
+    static void Encode(Builder_ &builder, const Tuple_ &data) {
+        Tupled<0, Args_...>::Head(builder, data, head_);
         Tupled<0, Args_...>::Tail(builder, data);
     }
 };
@@ -610,15 +643,28 @@ template <typename... Args_>
 struct Coder {
     typedef std::tuple<Args_...> Tuple;
 
+    static const bool dynamic_ = (Coded<Args_>::dynamic_ || ...);
+    static const size_t head_ = Coded<Tuple>::head_;
+
     static void Encode(Builder &builder, const Args_ &...args) {
-        return Coded<Tuple>::Encode(builder, Tuple(args...));
+        const auto tuple(std::tie(args...));
+        builder.reserve(builder.size() + Coded<Tuple>::Size(tuple));
+        Coded<Tuple>::Encode(builder, tuple);
     }
 
     static Builder Encode(const Args_ &...args) {
         Builder builder;
-        Coded<Tuple>::Encode(builder, Tuple(args...));
+        Encode(builder, args...);
         return builder;
     }
+
+    // tuples without dynamic members encode into a Brick on the stack
+    template <bool Dynamic_ = dynamic_>
+    static typename std::enable_if<!Dynamic_, Brick<head_>>::type Pack(const Args_ &...args) {
+        Mason<head_> mason;
+        Coded<Tuple>::Encode(mason, std::tie(args...));
+        return *mason;
+    }
 };
 
 uint256_t Timestamp();
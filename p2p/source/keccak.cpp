@@ -0,0 +1,205 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include <ethash/keccak.hpp>
+
+#include "keccak.hpp"
+
+namespace orc {
+
+static_assert(boost::endian::order::native == boost::endian::order::little);
+
+static uint64_t Load(const uint8_t *data) {
+    uint64_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+void Keccak::Absorb(const uint8_t *data, size_t size) {
+    const auto bytes(reinterpret_cast<uint8_t *>(state_));
+
+    if (offset_ != 0) {
+        const auto writ(std::min(size, Rate - offset_));
+        for (size_t i(0); i != writ; ++i)
+            bytes[offset_ + i] ^= data[i];
+        offset_ += writ;
+        if (offset_ != Rate)
+            return;
+        ethash_keccakf1600(state_);
+        offset_ = 0;
+        data += writ;
+        size -= writ;
+    }
+
+    for (; size >= Rate; data += Rate, size -= Rate) {
+        for (size_t i(0); i != Rate / 8; ++i)
+            state_[i] ^= Load(data + i * 8);
+        ethash_keccakf1600(state_);
+    }
+
+    for (size_t i(0); i != size; ++i)
+        bytes[i] ^= data[i];
+    offset_ = size;
+}
+
+Brick<32> Keccak::Finish() {
+    const auto bytes(reinterpret_cast<uint8_t *>(state_));
+    bytes[offset_] ^= 0x01;
+    bytes[Rate - 1] ^= 0x80;
+    ethash_keccakf1600(state_);
+
+    Brick<32> value;
+    memcpy(value.data(), state_, value.size());
+    return value;
+}
+
+
+template <size_t Ways_>
+struct Lanes;
+
+template <>
+struct Lanes<4> {
+    typedef uint64_t type __attribute__((__vector_size__(32)));
+};
+
+template <>
+struct Lanes<8> {
+    typedef uint64_t type __attribute__((__vector_size__(64)));
+};
+
+static const uint64_t Rounds_[24] = {
+    0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000,
+    0x000000000000808b, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
+    0x000000000000008a, 0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+    0x000000008000808b, 0x800000000000008b, 0x8000000000008089, 0x8000000000008003,
+    0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
+    0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008,
+};
+
+static const unsigned Rotations_[24] = {
+    1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14,
+    27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44,
+};
+
+static const unsigned Lanes_[24] = {
+    10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4,
+    15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1,
+};
+
+template <typename Lane_>
+static inline Lane_ Rotate(const Lane_ &value, unsigned bits) {
+    return value << bits | value >> (64 - bits);
+}
+
+template <typename Lane_>
+static void Permute(Lane_ (&state)[25]) {
+    for (const auto round : Rounds_) {
+        Lane_ parity[5];
+        for (size_t x(0); x != 5; ++x)
+            parity[x] = state[x] ^ state[x + 5] ^ state[x + 10] ^ state[x + 15] ^ state[x + 20];
+        for (size_t x(0); x != 5; ++x) {
+            const auto theta(parity[(x + 4) % 5] ^ Rotate(parity[(x + 1) % 5], 1));
+            for (size_t y(0); y != 25; y += 5)
+                state[y + x] ^= theta;
+        }
+
+        auto current(state[1]);
+        for (size_t i(0); i != 24; ++i) {
+            const auto next(state[Lanes_[i]]);
+            state[Lanes_[i]] = Rotate(current, Rotations_[i]);
+            current = next;
+        }
+
+        for (size_t y(0); y != 25; y += 5) {
+            Lane_ row[5];
+            for (size_t x(0); x != 5; ++x)
+                row[x] = state[y + x];
+            for (size_t x(0); x != 5; ++x)
+                state[y + x] = row[x] ^ (~row[(x + 1) % 5] & row[(x + 2) % 5]);
+        }
+
+        state[0] ^= round;
+    }
+}
+
+template <size_t Ways_>
+static void Hash(Brick<32> *hashes, const Region *const *data) {
+    typedef typename Lanes<Ways_>::type Lane;
+    Lane state[25] = {};
+
+    size_t blocks[Ways_];
+    size_t most(0);
+    for (size_t lane(0); lane != Ways_; ++lane) {
+        blocks[lane] = data[lane]->size() / Keccak::Rate + 1;
+        most = std::max(most, blocks[lane]);
+    }
+
+    for (size_t block(0); block != most; ++block) {
+        for (size_t lane(0); lane != Ways_; ++lane) {
+            if (block >= blocks[lane])
+                continue;
+
+            const auto size(data[lane]->size() - block * Keccak::Rate);
+            const auto here(data[lane]->data() + block * Keccak::Rate);
+
+            if (size >= Keccak::Rate)
+                for (size_t i(0); i != Keccak::Rate / 8; ++i)
+                    state[i][lane] ^= Load(here + i * 8);
+            else {
+                uint8_t last[Keccak::Rate] = {};
+                memcpy(last, here, size);
+                last[size] ^= 0x01;
+                last[Keccak::Rate - 1] ^= 0x80;
+                for (size_t i(0); i != Keccak::Rate / 8; ++i)
+                    state[i][lane] ^= Load(last + i * 8);
+            }
+        }
+
+        Permute(state);
+
+        for (size_t lane(0); lane != Ways_; ++lane)
+            if (block + 1 == blocks[lane])
+                for (size_t i(0); i != 4; ++i) {
+                    const uint64_t value(state[i][lane]);
+                    memcpy(hashes[lane].data() + i * 8, &value, sizeof(value));
+                }
+    }
+}
+
+void Hash(Brick<32> *hashes, const Region *const *data, size_t count) {
+#ifdef __AVX512F__
+    static const size_t Ways(8);
+#else
+    static const size_t Ways(4);
+#endif
+
+    for (; count >= Ways; hashes += Ways, data += Ways, count -= Ways)
+        Hash<Ways>(hashes, data);
+
+    for (; count != 0; ++hashes, ++data, --count) {
+        Keccak keccak;
+        keccak += **data;
+        *hashes = keccak.Finish();
+    }
+}
+
+}
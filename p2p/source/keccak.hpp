@@ -0,0 +1,65 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#ifndef ORCHID_KECCAK_HPP
+#define ORCHID_KECCAK_HPP
+
+#include "buffer.hpp"
+
+namespace orc {
+
+// Keccak-256 (not SHA3-256: this is the padding Ethereum uses)
+
+class Keccak {
+  public:
+    static const size_t Rate = 136;
+
+  private:
+    uint64_t state_[25];
+    size_t offset_;
+
+  public:
+    Keccak() :
+        state_{},
+        offset_(0)
+    {
+    }
+
+    void Absorb(const uint8_t *data, size_t size);
+
+    Keccak &operator +=(const Buffer &data) {
+        data.each([&](const uint8_t *data, size_t size) {
+            Absorb(data, size);
+            return true;
+        });
+        return *this;
+    }
+
+    Brick<32> Finish();
+};
+
+// hashes regions in lock-step across SIMD lanes (eight with AVX-512, else four)
+void Hash(Brick<32> *hashes, const Region *const *data, size_t count);
+
+}
+
+#endif//ORCHID_KECCAK_HPP
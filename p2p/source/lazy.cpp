@@ -0,0 +1,340 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "lazy.hpp"
+
+namespace orc {
+
+static bool Space(char value) {
+    switch (value) {
+        case ' ': case '\t': case '\n': case '\r':
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool Structural(char value) {
+    switch (value) {
+        case '{': case '}': case '[': case ']': case ':': case ',':
+            return true;
+        default:
+            return false;
+    }
+}
+
+Index::Index(const std::string_view &data) :
+    data_(data)
+{
+    orc_assert(data.size() < std::numeric_limits<uint32_t>::max());
+    tokens_.reserve(data.size() / 8);
+
+    bool string(false);
+    bool escaped(false);
+
+    const auto scalar([&](size_t offset) {
+        const auto value(data[offset]);
+        if (escaped)
+            escaped = false;
+        else if (string) {
+            if (value == '\\')
+                escaped = true;
+            else if (value == '"') {
+                string = false;
+                tokens_.push_back(offset);
+            }
+        } else if (value == '"') {
+            string = true;
+            tokens_.push_back(offset);
+        } else if (Structural(value))
+            tokens_.push_back(offset);
+    });
+
+    size_t offset(0);
+
+#ifdef __SSE2__
+    for (; offset + 16 <= data.size(); offset += 16) {
+        const auto chunk(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data.data() + offset)));
+        const auto equal([&](char value) {
+            return _mm_cmpeq_epi8(chunk, _mm_set1_epi8(value));
+        });
+
+        // escapes are rare enough in JSON-RPC that a block with any of them
+        // (or that starts in the middle of one) is simply walked bytewise
+        if (escaped || _mm_movemask_epi8(equal('\\')) != 0) {
+            for (size_t i(0); i != 16; ++i)
+                scalar(offset + i);
+            continue;
+        }
+
+        const unsigned quotes(_mm_movemask_epi8(equal('"')));
+        const unsigned structurals(_mm_movemask_epi8(_mm_or_si128(
+            _mm_or_si128(_mm_or_si128(equal('{'), equal('}')), _mm_or_si128(equal('['), equal(']'))),
+            _mm_or_si128(equal(':'), equal(',')))));
+
+        // the running parity of the quotes marks every byte inside a string
+        auto inside(quotes);
+        inside ^= inside << 1;
+        inside ^= inside << 2;
+        inside ^= inside << 4;
+        inside ^= inside << 8;
+        if (string)
+            inside = ~inside;
+        inside &= 0xffff;
+        string = (inside >> 15) != 0;
+
+        for (auto mask((structurals & ~inside) | quotes); mask != 0; mask &= mask - 1)
+            tokens_.push_back(offset + __builtin_ctz(mask));
+    }
+#endif
+
+    for (; offset != data.size(); ++offset)
+        scalar(offset);
+    orc_assert(!string);
+
+    jumps_.resize(tokens_.size());
+    std::vector<uint32_t> opens;
+    for (size_t token(0); token != tokens_.size(); ++token)
+        switch (const auto value = data[tokens_[token]]) {
+            case '{': case '[':
+                opens.push_back(token);
+            break;
+
+            case '}': case ']': {
+                orc_assert(!opens.empty());
+                const auto open(opens.back());
+                opens.pop_back();
+                orc_assert(data[tokens_[open]] == (value == '}' ? '{' : '['));
+                jumps_[open] = token;
+            } break;
+        }
+    orc_assert(opens.empty());
+}
+
+size_t Index::Skip(size_t offset) const {
+    while (offset != data_.size() && Space(data_[offset]))
+        ++offset;
+    orc_assert(offset != data_.size());
+    return offset;
+}
+
+Lazy Index::operator *() const {
+    return {*this, Skip(0), 0};
+}
+
+Lazy Lazy::After(size_t token) const {
+    const auto &index(*index_);
+    orc_assert(token < index.tokens_.size());
+    return {index, index.Skip(index.tokens_[token] + 1), token + 1};
+}
+
+size_t Lazy::Next() const {
+    switch (type()) {
+        case '{': case '[':
+            return index_->jumps_[token_] + 1;
+        case '"':
+            return token_ + 2;
+        default:
+            return token_;
+    }
+}
+
+std::string_view Lazy::text() const {
+    if (offset_ == std::string_view::npos)
+        return {};
+    const auto &data(index_->data_);
+    const auto &tokens(index_->tokens_);
+
+    switch (data[offset_]) {
+        case '{': case '[':
+            return data.substr(offset_, tokens[index_->jumps_[token_]] + 1 - offset_);
+        case '"':
+            return data.substr(offset_, tokens[token_ + 1] + 1 - offset_);
+
+        default: {
+            auto end(token_ == tokens.size() ? data.size() : tokens[token_]);
+            while (end != offset_ && Space(data[end - 1]))
+                --end;
+            return data.substr(offset_, end - offset_);
+        }
+    }
+}
+
+std::string_view Lazy::raw() const {
+    const auto text(this->text());
+    if (!isString())
+        return text;
+    return text.substr(1, text.size() - 2);
+}
+
+static unsigned Point(const std::string_view &raw, size_t &i) {
+    orc_assert(i + 4 < raw.size());
+    unsigned point(0);
+    for (const auto end(i + 4); i != end; ) {
+        const auto value(raw[++i]);
+        point <<= 4;
+        if (value >= '0' && value <= '9')
+            point |= value - '0';
+        else if (value >= 'a' && value <= 'f')
+            point |= value - 'a' + 10;
+        else if (value >= 'A' && value <= 'F')
+            point |= value - 'A' + 10;
+        else orc_throw("invalid escape");
+    }
+    return point;
+}
+
+std::string Lazy::asString() const {
+    switch (type()) {
+        case 'n':
+            return {};
+        case '"':
+            break;
+        default:
+            return std::string(text());
+    }
+
+    const auto raw(this->raw());
+    if (raw.find('\\') == std::string_view::npos)
+        return std::string(raw);
+
+    std::string value;
+    value.reserve(raw.size());
+
+    for (size_t i(0); i != raw.size(); ++i) {
+        if (raw[i] != '\\') {
+            value += raw[i];
+            continue;
+        }
+
+        orc_assert(++i != raw.size());
+        switch (raw[i]) {
+            case '"': case '\\': case '/':
+                value += raw[i];
+            break;
+
+            case 'b': value += '\b'; break;
+            case 'f': value += '\f'; break;
+            case 'n': value += '\n'; break;
+            case 'r': value += '\r'; break;
+            case 't': value += '\t'; break;
+
+            case 'u': {
+                auto point(Point(raw, i));
+                if (point >= 0xd800 && point < 0xdc00) {
+                    orc_assert(raw.substr(i + 1, 2) == "\\u");
+                    i += 2;
+                    const auto low(Point(raw, i));
+                    orc_assert(low >= 0xdc00 && low < 0xe000);
+                    point = 0x10000 + ((point - 0xd800) << 10) + (low - 0xdc00);
+                }
+
+                if (point < 0x80)
+                    value += char(point);
+                else if (point < 0x800) {
+                    value += char(0xc0 | point >> 6);
+                    value += char(0x80 | (point & 0x3f));
+                } else if (point < 0x10000) {
+                    value += char(0xe0 | point >> 12);
+                    value += char(0x80 | (point >> 6 & 0x3f));
+                    value += char(0x80 | (point & 0x3f));
+                } else {
+                    value += char(0xf0 | point >> 18);
+                    value += char(0x80 | (point >> 12 & 0x3f));
+                    value += char(0x80 | (point >> 6 & 0x3f));
+                    value += char(0x80 | (point & 0x3f));
+                }
+            } break;
+
+            default:
+                orc_throw("invalid escape");
+        }
+    }
+
+    return value;
+}
+
+Lazy Lazy::operator [](const std::string_view &key) const {
+    if (!isObject())
+        return {};
+
+    const auto &data(index_->data_);
+    const auto &tokens(index_->tokens_);
+    const auto close(index_->jumps_[token_]);
+
+    for (auto token(token_ + 1); token != close; ) {
+        // a member is a key's two quotes, then the colon, then the value
+        orc_assert(token + 2 < close);
+        orc_assert(data[tokens[token]] == '"');
+        orc_assert(data[tokens[token + 2]] == ':');
+
+        const auto value(After(token + 2));
+        if (data.substr(tokens[token] + 1, tokens[token + 1] - tokens[token] - 1) == key)
+            return value;
+
+        token = value.Next();
+        if (token == close)
+            break;
+        orc_assert(data[tokens[token]] == ',');
+        ++token;
+    }
+
+    return {};
+}
+
+Lazy Lazy::operator [](unsigned index) const {
+    if (!isArray())
+        return {};
+
+    const auto &tokens(index_->tokens_);
+    const auto close(index_->jumps_[token_]);
+
+    auto value(After(token_));
+    if (value.offset_ == tokens[close])
+        return {};
+
+    for (; index != 0; --index) {
+        const auto token(value.Next());
+        if (token == close)
+            return {};
+        orc_assert(index_->data_[tokens[token]] == ',');
+        value = After(token);
+    }
+
+    return value;
+}
+
+bool Lazy::operator ==(const std::string_view &value) const {
+    if (!isString())
+        return false;
+    const auto raw(this->raw());
+    if (raw.find('\\') == std::string_view::npos)
+        return raw == value;
+    return asString() == value;
+}
+
+}
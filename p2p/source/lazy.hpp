@@ -0,0 +1,166 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+
+#ifndef ORCHID_LAZY_HPP
+#define ORCHID_LAZY_HPP
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "json.hpp"
+
+namespace orc {
+
+class Lazy;
+
+// Index is a structural index over a JSON text (which must outlive it): a
+// single pass records the offset of every bracket, colon, comma and quote
+// that is not inside a string, and then pairs up every bracket; it never
+// builds a DOM, so walking a few fields costs nothing per skipped member
+
+class Index {
+    friend class Lazy;
+
+  private:
+    const std::string_view data_;
+    std::vector<uint32_t> tokens_;
+    std::vector<uint32_t> jumps_;
+
+    size_t Skip(size_t offset) const;
+
+  public:
+    Index(const std::string_view &data);
+
+    Lazy operator *() const;
+};
+
+// Lazy is a view of one value inside of an Index, named after Json::Value
+// so it can stand in for it; missing members and elements come back null
+
+class Lazy {
+    friend class Index;
+
+  private:
+    const Index *index_;
+    size_t offset_;
+    size_t token_;
+
+    Lazy(const Index &index, size_t offset, size_t token) :
+        index_(&index),
+        offset_(offset),
+        token_(token)
+    {
+    }
+
+    char type() const {
+        return offset_ == std::string_view::npos ? 'n' : index_->data_[offset_];
+    }
+
+    Lazy After(size_t token) const;
+    size_t Next() const;
+
+  public:
+    Lazy() :
+        index_(nullptr),
+        offset_(std::string_view::npos),
+        token_(0)
+    {
+    }
+
+    bool isNull() const {
+        return type() == 'n';
+    }
+
+    bool isObject() const {
+        return type() == '{';
+    }
+
+    bool isArray() const {
+        return type() == '[';
+    }
+
+    bool isString() const {
+        return type() == '"';
+    }
+
+    // the whole text of the value; empty if it is missing
+    std::string_view text() const;
+    // for strings, the contents with any escapes left intact
+    std::string_view raw() const;
+
+    std::string asString() const;
+
+    Lazy operator [](const std::string_view &key) const;
+    Lazy operator [](unsigned index) const;
+
+    Lazy operator [](const char *key) const {
+        return operator [](std::string_view(key));
+    }
+
+    Lazy operator [](int index) const {
+        return operator [](unsigned(index));
+    }
+
+    template <typename Code_>
+    void each(Code_ &&code) const {
+        if (!isArray())
+            return;
+        const auto close(index_->jumps_[token_]);
+        auto value(After(token_));
+        if (value.offset_ == index_->tokens_[close])
+            return;
+        for (;;) {
+            code(value);
+            const auto token(value.Next());
+            if (token == close)
+                return;
+            value = After(token);
+        }
+    }
+
+    size_t size() const {
+        size_t size(0);
+        each([&](const Lazy &) { ++size; });
+        return size;
+    }
+
+    Json::Value json() const {
+        return isNull() ? Json::Value() : Parse(std::string(text()));
+    }
+
+    bool operator ==(const std::string_view &value) const;
+
+    bool operator !=(const std::string_view &value) const {
+        return !operator ==(value);
+    }
+};
+
+inline std::ostream &operator <<(std::ostream &out, const Lazy &value) {
+    return out << (value.isNull() ? "null" : value.text());
+}
+
+}
+
+#endif//ORCHID_LAZY_HPP
@@ -20,7 +20,15 @@
 /* }}} */
 
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include <pthread.h>
 
@@ -42,21 +50,68 @@ namespace orc {
 
 bool Verbose(false);
 
-void Log_(std::ostream &out, Fiber *fiber) {
-    if (fiber == nullptr)
-        return;
-    Log_(out, fiber->Parent());
-    out << "[F:" << fiber << "] ";
+size_t Limiter::Take() noexcept {
+    // this is a generic cell rate algorithm: 20 messages, then 10 per second
+    static const uint64_t Interval(100000000);
+    static const uint64_t Burst(20);
+
+    const uint64_t now(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+
+    auto arrival(arrival_.load(std::memory_order_relaxed)); do {
+        const auto base(std::max(arrival, now));
+        if (base - now >= Interval * Burst) {
+            suppressed_.fetch_add(1, std::memory_order_relaxed);
+            return Deny;
+        }
+        if (arrival_.compare_exchange_weak(arrival, base + Interval, std::memory_order_relaxed))
+            break;
+    } while (true);
+
+    return suppressed_.exchange(0, std::memory_order_relaxed);
 }
 
-Log::Log(Fiber *fiber) noexcept { try {
-    *this << "[T:" << std::hex << pthread_self() << "] ";
-    Log_(*this, fiber);
-} catch (...) {
-} }
+namespace {
 
-Log::~Log() { try {
-    auto log(str());
+// Ring is a single-producer single-consumer queue owned by one thread: only
+// that thread pushes, and only whoever holds Logger::writing_ pops
+
+class Ring {
+  private:
+    static const size_t Size = 1024;
+
+    std::array<std::string, Size> logs_;
+    std::atomic<size_t> head_ = 0;
+    std::atomic<size_t> tail_ = 0;
+
+  public:
+    const pthread_t thread_ = pthread_self();
+    std::atomic<size_t> dropped_ = 0;
+    std::atomic<bool> done_ = false;
+
+    bool Push(std::string &&log) {
+        const auto tail(tail_.load(std::memory_order_relaxed));
+        if (tail - head_.load(std::memory_order_acquire) == Size)
+            return false;
+        logs_[tail % Size] = std::move(log);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    bool Pop(std::string &log) {
+        const auto head(head_.load(std::memory_order_relaxed));
+        if (head == tail_.load(std::memory_order_acquire))
+            return false;
+        log = std::move(logs_[head % Size]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+void Write(std::string log) {
     if (!log.empty() && log[log.size() - 1] == '\n')
         log.resize(log.size() - 1);
 
@@ -76,6 +131,145 @@ Log::~Log() { try {
 #else
     std::cerr << log << std::endl;
 #endif
+}
+
+class Logger {
+  private:
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<Ring>> rings_;
+    std::condition_variable ready_;
+    std::atomic<bool> sleeping_ = false;
+
+  public:
+    std::mutex writing_;
+
+    static Logger &Get() {
+        // this is leaked on purpose: threads might still log during exit
+        static auto logger([]() {
+            const auto logger(new Logger());
+            std::thread([logger]() {
+                logger->Run();
+            }).detach();
+            std::atexit([]() { Flush(); });
+            return logger;
+        }());
+        return *logger;
+    }
+
+    void Insert(std::shared_ptr<Ring> ring) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        rings_.emplace_back(std::move(ring));
+    }
+
+    void Wake() {
+        if (sleeping_.exchange(false, std::memory_order_acq_rel)) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.notify_one();
+        }
+    }
+
+    // must be called with writing_ held; returns the number of messages
+    size_t Drain() {
+        const auto rings([&]() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            return rings_;
+        }());
+
+        size_t count(0);
+        std::string log;
+
+        for (const auto &ring : rings) {
+            while (ring->Pop(log)) {
+                Write(std::move(log));
+                ++count;
+            }
+
+            if (const auto dropped = ring->dropped_.exchange(0, std::memory_order_relaxed)) {
+                std::ostringstream out;
+                out << "[T:" << std::hex << ring->thread_ << "] dropped " << std::dec << dropped << " log messages";
+                Write(out.str());
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [](const auto &ring) {
+            return ring->done_.load(std::memory_order_acquire) && ring->Empty();
+        }), rings_.end());
+
+        return count;
+    }
+
+    void Run() {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> writing(writing_);
+                if (Drain() != 0)
+                    continue;
+            }
+
+            // a wakeup lost to the race with sleeping_ costs at most a tick
+            std::unique_lock<std::mutex> lock(mutex_);
+            sleeping_.store(true, std::memory_order_release);
+            ready_.wait_for(lock, std::chrono::milliseconds(50));
+        }
+    }
+};
+
+class Local {
+  public:
+    const std::shared_ptr<Ring> ring_;
+
+    Local() :
+        ring_(std::make_shared<Ring>())
+    {
+        Logger::Get().Insert(ring_);
+    }
+
+    ~Local() {
+        ring_->done_.store(true, std::memory_order_release);
+    }
+};
+
+}
+
+void Flush() noexcept { try {
+    auto &logger(Logger::Get());
+    std::unique_lock<std::mutex> writing(logger.writing_);
+    logger.Drain();
+} catch (...) {
+} }
+
+void Log_(std::ostream &out, Fiber *fiber) {
+    if (fiber == nullptr)
+        return;
+    Log_(out, fiber->Parent());
+    out << "[F:" << fiber << "] ";
+}
+
+Log::Log(Fiber *fiber, Level level, size_t suppressed) noexcept :
+    level_(level)
+{ try {
+    *this << "[T:" << std::hex << pthread_self() << "] ";
+    Log_(*this, fiber);
+    if (suppressed != 0)
+        *this << "[S:" << std::dec << suppressed << "] ";
+} catch (...) {
+} }
+
+Log::~Log() { try {
+    if (level_ >= Level::Fatal) {
+        auto &logger(Logger::Get());
+        std::unique_lock<std::mutex> writing(logger.writing_);
+        logger.Drain();
+        Write(str());
+        return;
+    }
+
+    thread_local Local local;
+    auto &logger(Logger::Get());
+    if (!local.ring_->Push(str()))
+        local.ring_->dropped_.fetch_add(1, std::memory_order_relaxed);
+    logger.Wake();
 } catch (...) {
     // XXX: maybe there's a backup plan?
 } }
@@ -23,23 +23,67 @@
 #ifndef ORCHID_LOG_HPP
 #define ORCHID_LOG_HPP
 
+#include <atomic>
 #include <cstdarg>
+#include <cstdint>
 #include <sstream>
 
+// messages below this Level are compiled out of orc_Level() entirely
+#ifndef ORC_LOG
+#define ORC_LOG Trace
+#endif
+
 namespace orc {
 
 extern bool Verbose;
 
+enum class Level : uint8_t {
+    Trace,
+    Debug,
+    Info,
+    Warning,
+    Fatal,
+};
+
+// Debug and Trace messages are only formatted when running Verbose
+inline bool Logging(Level level) {
+    if (level < Level::ORC_LOG)
+        return false;
+    return level >= Level::Info || Verbose;
+}
+
+// Limiter lets a burst of messages through from a single call site, and
+// then a steady trickle, counting what it drops so the next one can say so
+
+class Limiter {
+  private:
+    std::atomic<uint64_t> arrival_ = 0;
+    std::atomic<size_t> suppressed_ = 0;
+
+  public:
+    static const size_t Deny = ~size_t(0);
+
+    size_t Take() noexcept;
+};
+
 class Fiber;
 
+// Log is formatted on the calling thread but written by a background thread
+// (except for Fatal, which first flushes everything and writes in place)
+
 class Log final :
     public std::ostringstream
 {
+  private:
+    const Level level_;
+
   public:
-    Log(Fiber *fiber = nullptr) noexcept;
+    Log(Fiber *fiber = nullptr, Level level = Level::Info, size_t suppressed = 0) noexcept;
     ~Log() override;
 };
 
+void Flush() noexcept;
+
 }
 
 inline constexpr orc::Fiber *const orc_fiber = nullptr;
@@ -52,6 +96,13 @@ inline constexpr orc::Fiber *const orc_fiber = nullptr;
 #define orc_Log() \
     orc::Log(orc_fiber)
 
+// a for (rather than if/else) runs the message at most once and leaves no
+// else behind for a following one to bind to
+#define orc_Level(level) \
+    for (size_t orc_suppressed(orc::Logging(orc::Level::level) ? []() -> orc::Limiter & { static orc::Limiter limiter; return limiter; }().Take() : orc::Limiter::Deny); \
+        orc_suppressed != orc::Limiter::Deny; orc_suppressed = orc::Limiter::Deny) \
+        orc::Log(orc_fiber, orc::Level::level, orc_suppressed)
+
 #define orc_log(log, text) \
     log << "[" << __FILE__ << ":" << std::dec << __LINE__ << "] " << text
 
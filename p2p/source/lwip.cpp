@@ -21,8 +21,12 @@
 #endif
 
 #include <lwip/opt.h>
+#include <lwip/api.h>
+#include <lwip/priv/sockets_priv.h>
 #include <lwip/sockets.h>
 #include <lwip/sys.h>
+#include <lwip/tcp.h>
+#include <lwip/tcpip.h>
 
 #ifndef TCP_NODELAY
 #define TCP_NODELAY    0x01    /* don't delay send to coalesce packets */
@@ -46,10 +50,6 @@
 #pragma warning(disable : 4786)
 #endif
 
-#ifdef MEMORY_SANITIZER
-#include <sanitizer/msan_interface.h>
-#endif
-
 #include <string.h>
 #include <signal.h>
 #include <unistd.h>
@@ -625,94 +625,140 @@ int SocketDispatcher::Close() {
   return LwipSocket::Close();
 }
 
-class EventDispatcher : public Dispatcher {
+void SocketDispatcher::SetEnabledEvents(uint8_t events) {
+  uint8_t old_events = enabled_events();
+  LwipSocket::SetEnabledEvents(events);
+  MaybeUpdateDispatcher(old_events);
+}
+
+void SocketDispatcher::EnableEvents(uint8_t events) {
+  uint8_t old_events = enabled_events();
+  LwipSocket::EnableEvents(events);
+  MaybeUpdateDispatcher(old_events);
+}
+
+void SocketDispatcher::MaybeUpdateDispatcher(uint8_t old_events) {
+  // lwIP only calls back when something changes, so an event that is asked
+  // for again (say, DE_READ after a partial Recv) has to be looked at anew.
+  if (GetDescriptor() != INVALID_SOCKET &&
+      (enabled_events() & ~old_events) != 0) {
+    ss_->Update(this);
+  }
+}
+
+// Sets the value of a boolean value to false when signaled.
+class Signaler : public Dispatcher {
  public:
-  EventDispatcher(LwipSocketServer* ss) : ss_(ss), fSignaled_(false) {
-    afd_[0] = ::lwip_socket(PF_INET, SOCK_DGRAM, 0);
-    if (afd_[0] < 0)
-      RTC_LOG(LERROR) << "pipe 1 failed";
-    afd_[1] = ::lwip_socket(PF_INET, SOCK_DGRAM, 0);
-    if (afd_[1] < 0)
-      RTC_LOG(LERROR) << "pipe 2 failed";
-    struct sockaddr_in addr;
-    addr.sin_family = AF_INET;
-    addr.sin_port = 0;
-    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
-    int r = ::lwip_bind(afd_[0], (const struct sockaddr *)&addr, sizeof(addr));
-    if (r < 0)
-        RTC_LOG(LERROR) << "pipe bind failed";
-    socklen_t addrlen = sizeof(addr);
-    r = ::lwip_getsockname(afd_[0], (struct sockaddr *)&addr, &addrlen);
-    if (r < 0)
-        RTC_LOG(LERROR) << "pipe getsockaddr failed";
-    r = ::lwip_connect(afd_[1], (const struct sockaddr *)&addr, addrlen);
-    if (r < 0)
-        RTC_LOG(LERROR) << "pipe connect failed";
-    ss_->Add(this);
-  }
-
-  ~EventDispatcher() override {
-    ss_->Remove(this);
-    ::lwip_close(afd_[0]);
-    ::lwip_close(afd_[1]);
-  }
-
-  virtual void Signal() {
-    CritScope cs(&crit_);
-    if (!fSignaled_) {
-      const uint8_t b[1] = {0};
-      const ssize_t res = ::lwip_send(afd_[1], b, sizeof(b), 0);
-      RTC_DCHECK_EQ(1, res);
-      fSignaled_ = true;
+  Signaler(LwipSocketServer* ss, bool* pf) : ss_(ss), pf_(pf) {}
+  ~Signaler() override {}
+
+  void Signal() {
+    CritScope cs(&LwipSocketServer::ready_crit_);
+    if (!ss_->signaled_) {
+      ss_->signaled_ = true;
+      ss_->wakeup_.Set();
     }
   }
 
   uint32_t GetRequestedEvents() override { return DE_READ; }
 
-  void OnPreEvent(uint32_t ff) override {
-    // It is not possible to perfectly emulate an auto-resetting event with
-    // pipes.  This simulates it by resetting before the event is handled.
+  void OnPreEvent(uint32_t ff) override {}
 
-    CritScope cs(&crit_);
-    if (fSignaled_) {
-      uint8_t b[4];  // Allow for reading more than 1 byte, but expect 1.
-      const ssize_t res = ::lwip_recv(afd_[0], b, sizeof(b), 0);
-      RTC_DCHECK_EQ(1, res);
-      fSignaled_ = false;
-    }
+  void OnEvent(uint32_t ff, int err) override {
+    if (pf_)
+      *pf_ = false;
   }
 
-  void OnEvent(uint32_t ff, int err) override { RTC_NOTREACHED(); }
-
-  int GetDescriptor() override { return afd_[0]; }
+  int GetDescriptor() override { return INVALID_SOCKET; }
 
   bool IsDescriptorClosed() override { return false; }
 
  private:
   LwipSocketServer* ss_;
-  int afd_[2];
-  bool fSignaled_;
-  CriticalSection crit_;
+  bool* pf_;
 };
 
-// Sets the value of a boolean value to false when signaled.
-class Signaler : public EventDispatcher {
- public:
-  Signaler(LwipSocketServer* ss, bool* pf) : EventDispatcher(ss), pf_(pf) {}
-  ~Signaler() override {}
+// What lwIP has said about one descriptor. lwIP calls a netconn's callback
+// with nothing but the netconn, whose socket is its descriptor, so these are
+// kept in a table indexed by descriptor.
+struct Readiness {
+  static void OnEvent(struct netconn* conn, enum netconn_evt evt, u16_t len);
+
+  // Descriptors are reused; these are only about this netconn.
+  struct netconn* conn;
+  LwipSocketServer* ss;
+  Dispatcher* dispatcher;
+  // Counted as lwIP's own event_callback counts them for select().
+  int rcvevent;
+  bool sendevent;
+  bool queued;
+};
 
-  void OnEvent(uint32_t ff, int err) override {
-    if (pf_)
-      *pf_ = false;
+static Readiness readinesses_[MEMP_NUM_NETCONN];
+
+CriticalSection LwipSocketServer::ready_crit_;
+
+static Readiness* GetReadiness(int fd) {
+  const int index = fd - LWIP_SOCKET_OFFSET;
+  if (index < 0 || index >= MEMP_NUM_NETCONN)
+    return nullptr;
+  return &readinesses_[index];
+}
+
+void Readiness::OnEvent(struct netconn* conn, enum netconn_evt evt, u16_t len) {
+  SYS_ARCH_DECL_PROTECT(lev);
+  SYS_ARCH_PROTECT(lev);
+  const int fd = conn->socket;
+  if (fd < 0) {
+    // Data can arrive before lwip_accept gives the netconn a descriptor. It
+    // replays the events counted down here once it has one.
+    if (evt == NETCONN_EVT_RCVPLUS)
+      --conn->socket;
+    SYS_ARCH_UNPROTECT(lev);
+    return;
   }
+  SYS_ARCH_UNPROTECT(lev);
 
- private:
-  bool* pf_;
-};
+  Readiness* readiness = GetReadiness(fd);
+  if (readiness == nullptr)
+    return;
+
+  CritScope cs(&LwipSocketServer::ready_crit_);
+  if (readiness->conn != conn) {
+    *readiness = Readiness();
+    readiness->conn = conn;
+  }
+
+  bool ready = false;
+  switch (evt) {
+    case NETCONN_EVT_RCVPLUS:
+      ++readiness->rcvevent;
+      ready = true;
+      break;
+    case NETCONN_EVT_RCVMINUS:
+      if (readiness->rcvevent > 0)
+        --readiness->rcvevent;
+      break;
+    case NETCONN_EVT_SENDPLUS:
+      readiness->sendevent = true;
+      ready = true;
+      break;
+    case NETCONN_EVT_SENDMINUS:
+      readiness->sendevent = false;
+      break;
+    case NETCONN_EVT_ERROR:
+      ready = true;
+      break;
+  }
+
+  if (ready && readiness->ss != nullptr && !readiness->queued)
+    readiness->ss->Ready(fd);
+}
 
 LwipSocketServer::LwipSocketServer()
     :
-      fWait_(false) {
+      fWait_(false),
+      wakeup_(false, false) {
   signal_wakeup_ = new Signaler(this, &fWait_);
 }
 
@@ -756,64 +802,84 @@ AsyncSocket* LwipSocketServer::WrapSocket(SOCKET s) {
 }
 
 void LwipSocketServer::Add(Dispatcher* pdispatcher) {
-  CritScope cs(&crit_);
-  if (processing_dispatchers_) {
-    // A dispatcher is being added while a "Wait" call is processing the
-    // list of socket events.
-    // Defer adding to "dispatchers_" set until processing is done to avoid
-    // invalidating the iterator in "Wait".
-    pending_remove_dispatchers_.erase(pdispatcher);
-    pending_add_dispatchers_.insert(pdispatcher);
-  } else {
+  {
+    CritScope cs(&crit_);
     dispatchers_.insert(pdispatcher);
   }
+
+  const int fd = pdispatcher->GetDescriptor();
+  Readiness* readiness = GetReadiness(fd);
+  if (readiness == nullptr)
+    return;
+
+  struct lwip_sock* sock = lwip_socket_dbg_get_socket(fd);
+  RTC_DCHECK(sock);
+  struct netconn* conn = sock->conn;
+
+  LOCK_TCPIP_CORE();
+  // Without LWIP_SOCKET_SELECT, lwIP's sockets install no callback of their
+  // own; an accepted netconn inherits this one from its listener.
+  RTC_DCHECK(conn->callback == nullptr ||
+             conn->callback == &Readiness::OnEvent);
+  conn->callback = &Readiness::OnEvent;
+  // As lwIP's select() would, count TCP writable once it has connected.
+  const bool writable =
+      NETCONNTYPE_GROUP(netconn_type(conn)) != NETCONN_TCP ||
+      conn->pcb.tcp == nullptr || conn->pcb.tcp->state != CLOSED;
+  UNLOCK_TCPIP_CORE();
+
+  CritScope cs(&ready_crit_);
+  if (readiness->conn != conn) {
+    *readiness = Readiness();
+    readiness->conn = conn;
+  }
+  readiness->ss = this;
+  readiness->dispatcher = pdispatcher;
+  readiness->sendevent = readiness->sendevent || writable;
+  if (!readiness->queued)
+    Ready(fd);
 }
 
 void LwipSocketServer::Remove(Dispatcher* pdispatcher) {
-  CritScope cs(&crit_);
-  if (processing_dispatchers_) {
-    // A dispatcher is being removed while a "Wait" call is processing the
-    // list of socket events.
-    // Defer removal from "dispatchers_" set until processing is done to avoid
-    // invalidating the iterator in "Wait".
-    if (!pending_add_dispatchers_.erase(pdispatcher) &&
-        dispatchers_.find(pdispatcher) == dispatchers_.end()) {
-      RTC_LOG(LS_WARNING) << "LwipSocketServer asked to remove a unknown "
-                          << "dispatcher, potentially from a duplicate call to "
-                          << "Add.";
+  {
+    CritScope cs(&crit_);
+    if (!dispatchers_.erase(pdispatcher)) {
+      RTC_LOG(LS_WARNING)
+          << "LwipSocketServer asked to remove a unknown "
+          << "dispatcher, potentially from a duplicate call to Add.";
       return;
     }
+  }
 
-    pending_remove_dispatchers_.insert(pdispatcher);
-  } else if (!dispatchers_.erase(pdispatcher)) {
-    RTC_LOG(LS_WARNING)
-        << "LwipSocketServer asked to remove a unknown "
-        << "dispatcher, potentially from a duplicate call to Add.";
+  Readiness* readiness = GetReadiness(pdispatcher->GetDescriptor());
+  if (readiness == nullptr)
     return;
+
+  // If the descriptor is still queued, ProcessReady will skip it.
+  CritScope cs(&ready_crit_);
+  if (readiness->dispatcher == pdispatcher) {
+    readiness->ss = nullptr;
+    readiness->dispatcher = nullptr;
   }
 }
 
 void LwipSocketServer::Update(Dispatcher* pdispatcher) {
-}
-
-void LwipSocketServer::AddRemovePendingDispatchers() {
-  if (!pending_add_dispatchers_.empty()) {
-    for (Dispatcher* pdispatcher : pending_add_dispatchers_) {
-      dispatchers_.insert(pdispatcher);
-    }
-    pending_add_dispatchers_.clear();
-  }
+  const int fd = pdispatcher->GetDescriptor();
+  Readiness* readiness = GetReadiness(fd);
+  if (readiness == nullptr)
+    return;
 
-  if (!pending_remove_dispatchers_.empty()) {
-    for (Dispatcher* pdispatcher : pending_remove_dispatchers_) {
-      dispatchers_.erase(pdispatcher);
-    }
-    pending_remove_dispatchers_.clear();
-  }
+  CritScope cs(&ready_crit_);
+  if (readiness->dispatcher == pdispatcher && !readiness->queued)
+    Ready(fd);
 }
 
-bool LwipSocketServer::Wait(int cmsWait, bool process_io) {
-  return WaitSelect(cmsWait, process_io);
+void LwipSocketServer::Ready(int fd) {
+  GetReadiness(fd)->queued = true;
+  // Wait only sleeps once it has emptied the list.
+  if (ready_.empty())
+    wakeup_.Set();
+  ready_.push_back(fd);
 }
 
 static void ProcessEvents(Dispatcher* dispatcher,
@@ -865,122 +931,77 @@ static void ProcessEvents(Dispatcher* dispatcher,
   }
 }
 
-bool LwipSocketServer::WaitSelect(int cmsWait, bool process_io) {
-  // Calculate timing information
-
-  struct timeval* ptvWait = nullptr;
-  struct timeval tvWait;
-  int64_t stop_us;
-  if (cmsWait != kForever) {
-    // Calculate wait timeval
-    tvWait.tv_sec = cmsWait / 1000;
-    tvWait.tv_usec = (cmsWait % 1000) * 1000;
-    ptvWait = &tvWait;
+void LwipSocketServer::ProcessReady(int fd) {
+  Readiness* readiness = GetReadiness(fd);
+  Dispatcher* pdispatcher;
+  bool readable;
+  bool writable;
+  {
+    CritScope cs(&ready_crit_);
+    readiness->queued = false;
+    // The dispatcher may have been removed since this was queued.
+    if (readiness->ss != this)
+      return;
+    pdispatcher = readiness->dispatcher;
+    readable = readiness->rcvevent > 0;
+    writable = readiness->sendevent;
+  }
 
-    // Calculate when to return
-    stop_us = rtc::TimeMicros() + cmsWait * 1000;
+  if (!readable) {
+    // A recv that did not take all of a packet keeps the rest here.
+    struct lwip_sock* sock = lwip_socket_dbg_get_socket(fd);
+    readable = sock != nullptr && sock->lastdata.pbuf != nullptr;
   }
 
-  // Zero all fd_sets. Don't need to do this inside the loop since
-  // select() zeros the descriptors not signaled
+  uint32_t ff = pdispatcher->GetRequestedEvents();
+  readable = readable && (ff & (DE_READ | DE_ACCEPT)) != 0;
+  writable = writable && (ff & (DE_WRITE | DE_CONNECT)) != 0;
 
-  fd_set fdsRead;
-  FD_ZERO(&fdsRead);
-  fd_set fdsWrite;
-  FD_ZERO(&fdsWrite);
-// Explicitly unpoison these FDs on MemorySanitizer which doesn't handle the
-// inline assembly in FD_ZERO.
-// http://crbug.com/344505
-#ifdef MEMORY_SANITIZER
-  __msan_unpoison(&fdsRead, sizeof(fdsRead));
-  __msan_unpoison(&fdsWrite, sizeof(fdsWrite));
-#endif
+  // The error code can be signaled through reads or writes.
+  ProcessEvents(pdispatcher, readable, writable, readable || writable);
+}
+
+bool LwipSocketServer::Wait(int cmsWait, bool process_io) {
+  // Calculate when to return
+  int64_t stop_ms = 0;
+  if (cmsWait != kForever)
+    stop_ms = rtc::TimeMillis() + cmsWait;
 
   fWait_ = true;
 
   while (fWait_) {
-    int fdmax = -1;
+    std::vector<int> ready;
+    bool signaled;
     {
-      CritScope cr(&crit_);
-      // TODO(jbauch): Support re-entrant waiting.
-      RTC_DCHECK(!processing_dispatchers_);
-      for (Dispatcher* pdispatcher : dispatchers_) {
-        // Query dispatchers for read and write wait state
-        RTC_DCHECK(pdispatcher);
-        if (!process_io && (pdispatcher != signal_wakeup_))
-          continue;
-        int fd = pdispatcher->GetDescriptor();
-        // "select"ing a file descriptor that is equal to or larger than
-        // FD_SETSIZE will result in undefined behavior.
-        RTC_DCHECK_LT(fd, FD_SETSIZE);
-        if (fd > fdmax)
-          fdmax = fd;
-
-        uint32_t ff = pdispatcher->GetRequestedEvents();
-        if (ff & (DE_READ | DE_ACCEPT))
-          FD_SET(fd, &fdsRead);
-        if (ff & (DE_WRITE | DE_CONNECT))
-          FD_SET(fd, &fdsWrite);
-      }
+      CritScope cs(&ready_crit_);
+      signaled = signaled_;
+      signaled_ = false;
+      // Without process_io, the queue is left for a later call.
+      if (process_io)
+        ready.swap(ready_);
     }
 
-    // Wait then call handlers as appropriate
-    // < 0 means error
-    // 0 means timeout
-    // > 0 means count of descriptors ready
-    int n = ::lwip_select(fdmax + 1, &fdsRead, &fdsWrite, nullptr, ptvWait);
+    if (signaled) {
+      signal_wakeup_->OnPreEvent(DE_READ);
+      signal_wakeup_->OnEvent(DE_READ, 0);
+    }
 
-    // If error, return error.
-    if (n < 0) {
-      if (errno != EINTR) {
-        RTC_LOG_E(LS_ERROR, EN, errno) << "select";
-        return false;
-      }
-      // Else ignore the error and keep going. If this EINTR was for one of the
-      // signals managed by this LwipSocketServer, the
-      // PosixSignalDeliveryDispatcher will be in the signaled state in the next
-      // iteration.
-    } else if (n == 0) {
-      // If timeout, return success
-      return true;
-    } else {
-      // We have signaled descriptors
-      CritScope cr(&crit_);
-      processing_dispatchers_ = true;
-      for (Dispatcher* pdispatcher : dispatchers_) {
-        int fd = pdispatcher->GetDescriptor();
-
-        bool readable = FD_ISSET(fd, &fdsRead);
-        if (readable) {
-          FD_CLR(fd, &fdsRead);
-        }
-
-        bool writable = FD_ISSET(fd, &fdsWrite);
-        if (writable) {
-          FD_CLR(fd, &fdsWrite);
-        }
-
-        // The error code can be signaled through reads or writes.
-        ProcessEvents(pdispatcher, readable, writable, readable || writable);
-      }
+    // Only descriptors that lwIP said something about are here, however
+    // many dispatchers there are.
+    for (int fd : ready)
+      ProcessReady(fd);
 
-      processing_dispatchers_ = false;
-      // Process deferred dispatchers that have been added/removed while the
-      // events were handled above.
-      AddRemovePendingDispatchers();
-    }
+    if (signaled || !ready.empty())
+      continue;
 
-    // Recalc the time remaining to wait. Doing it here means it doesn't get
-    // calced twice the first time through the loop
-    if (ptvWait) {
-      ptvWait->tv_sec = 0;
-      ptvWait->tv_usec = 0;
-      int64_t time_left_us = stop_us - rtc::TimeMicros();
-      if (time_left_us > 0) {
-        ptvWait->tv_sec = time_left_us / rtc::kNumMicrosecsPerSec;
-        ptvWait->tv_usec = time_left_us % rtc::kNumMicrosecsPerSec;
-      }
-    }
+    int cms = kForever;
+    if (cmsWait != kForever)
+      cms = static_cast<int>(
+          std::max<int64_t>(0, stop_ms - rtc::TimeMillis()));
+
+    // If timeout, return success
+    if (!wakeup_.Wait(cms))
+      return true;
   }
 
   return true;
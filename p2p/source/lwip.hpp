@@ -17,6 +17,7 @@
 #include <vector>
 
 #include "rtc_base/critical_section.h"
+#include "rtc_base/event.h"
 #include "rtc_base/net_helpers.h"
 #include "rtc_base/socket_server.h"
 #include "rtc_base/system/rtc_export.h"
@@ -38,6 +39,7 @@ enum DispatcherEvent {
 };
 
 class Signaler;
+struct Readiness;
 
 class Dispatcher {
  public:
@@ -71,21 +73,27 @@ class RTC_EXPORT LwipSocketServer : public SocketServer {
   void Update(Dispatcher* dispatcher);
 
  private:
-  // The number of events to process with one call to "epoll_wait".
-  static constexpr size_t kNumEpollEvents = 128;
+  // lwIP reports socket events through a netconn callback, which queues the
+  // descriptor here; Wait() then only looks at descriptors that had events,
+  // rather than at every dispatcher as select() would.
+  friend class Signaler;
+  friend struct Readiness;
 
   typedef std::set<Dispatcher*> DispatcherSet;
 
-  void AddRemovePendingDispatchers() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void Ready(int fd) RTC_EXCLUSIVE_LOCKS_REQUIRED(ready_crit_);
+  void ProcessReady(int fd);
 
-  bool WaitSelect(int cms, bool process_io);
   DispatcherSet dispatchers_ RTC_GUARDED_BY(crit_);
-  DispatcherSet pending_add_dispatchers_ RTC_GUARDED_BY(crit_);
-  DispatcherSet pending_remove_dispatchers_ RTC_GUARDED_BY(crit_);
-  bool processing_dispatchers_ RTC_GUARDED_BY(crit_) = false;
   Signaler* signal_wakeup_;  // Assigned in constructor only
   CriticalSection crit_;
   bool fWait_;
+
+  // Shared with the callback, which lwIP calls without any server to lock.
+  static CriticalSection ready_crit_;
+  std::vector<int> ready_ RTC_GUARDED_BY(ready_crit_);
+  bool signaled_ RTC_GUARDED_BY(ready_crit_) = false;
+  rtc::Event wakeup_;
 };
 
 class LwipSocket : public AsyncSocket, public sigslot::has_slots<> {
@@ -194,8 +202,12 @@ class SocketDispatcher : public Dispatcher, public LwipSocket {
 
   int Close() override;
 
+ protected:
+  void SetEnabledEvents(uint8_t events) override;
+  void EnableEvents(uint8_t events) override;
 
  private:
+  void MaybeUpdateDispatcher(uint8_t old_events);
 };
 
 }  // namespace orc
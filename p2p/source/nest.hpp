@@ -24,24 +24,53 @@
 #define ORCHID_NEST_HPP
 
 #include <atomic>
+#include <deque>
 
 #include <cppcoro/single_consumer_event.hpp>
 
+#include "event.hpp"
+#include "locked.hpp"
 #include "log.hpp"
+#include "shared.hpp"
 #include "spawn.hpp"
 #include "task.hpp"
 #include "valve.hpp"
 
 namespace orc {
 
+// what a full Nest does with more work: drop it, queue it (up to a bound)
+// until something finishes, or queue it and drop the oldest queued instead
+enum class Admission : uint8_t {
+    Drop,
+    Wait,
+    Oldest,
+};
+
 class Nest :
     public Covered<Valve>
 {
   private:
+    const Admission admission_;
+    const size_t waiting_;
+
     std::atomic<unsigned> limit_;
     std::atomic<unsigned> count_ = 0;
     Event event_;
 
+    struct Waiter {
+        Event ready_;
+        bool admitted_ = false;
+    };
+
+    struct Locked_ {
+        std::deque<S<Waiter>> waiters_;
+    }; Locked<Locked_> locked_;
+
+    std::atomic<uint64_t> hatched_ = 0;
+    std::atomic<uint64_t> waited_ = 0;
+    std::atomic<uint64_t> dropped_ = 0;
+    std::atomic<uint64_t> evicted_ = 0;
+
     class Count {
       private:
         Nest *nest_;
@@ -55,19 +84,23 @@ class Nest :
             //Log() << "Nest[" << nest_ << "]: " << std::dec << count_ << std::endl;
         }
 
+        // this adopts a slot that Join() or Leave() already accounted for
+        Count(Nest *nest, unsigned count) noexcept :
+            nest_(nest),
+            count_(count)
+        {
+        }
+
         Count(Count &&count) noexcept :
-            nest_(count.nest_)
+            nest_(count.nest_),
+            count_(count.count_)
         {
             count.nest_ = nullptr;
         }
 
         ~Count() {
-            if (nest_ == nullptr)
-                return;
-            const auto count(--nest_->count_);
-            if (count == 0 && nest_->limit_ == 0)
-                nest_->event_();
-            //Log() << "Nest[" << nest_ << "]: " << std::dec << count << std::endl;
+            if (nest_ != nullptr)
+                nest_->Leave();
         }
 
         operator unsigned() const noexcept {
@@ -75,8 +108,85 @@ class Nest :
         }
     };
 
+    void Leave() noexcept {
+        S<Waiter> waiter;
+        unsigned count;
+
+        if (admission_ == Admission::Drop)
+            count = --count_;
+        else {
+            // this must decrement under the lock, or Join() could queue a
+            // waiter just after we decided there weren't any to hand off to
+            const auto locked(locked_());
+            if (locked->waiters_.empty())
+                count = --count_;
+            else {
+                // the slot passes straight to the oldest waiter, so count_ stays
+                waiter = std::move(locked->waiters_.front());
+                locked->waiters_.pop_front();
+            }
+        }
+
+        if (waiter != nullptr) {
+            waiter->admitted_ = true;
+            waiter->ready_();
+            return;
+        }
+
+        if (count == 0 && limit_ == 0)
+            event_();
+        //Log() << "Nest[" << this << "]: " << std::dec << count << std::endl;
+    }
+
+    // false means the work was rejected; a null Waiter means it has a slot now
+    std::pair<bool, S<Waiter>> Join() {
+        if (admission_ == Admission::Drop) {
+            if (++count_ <= limit_)
+                return {true, nullptr};
+            Leave();
+            ++dropped_;
+            return {false, nullptr};
+        }
+
+        S<Waiter> evicted;
+        const auto joined([&]() -> std::pair<bool, S<Waiter>> {
+            const auto locked(locked_());
+            if (locked->waiters_.empty() && count_ < limit_) {
+                ++count_;
+                return {true, nullptr};
+            }
+
+            if (limit_ == 0)
+                return {false, nullptr};
+
+            if (locked->waiters_.size() >= waiting_) {
+                if (admission_ != Admission::Oldest || locked->waiters_.empty())
+                    return {false, nullptr};
+                evicted = std::move(locked->waiters_.front());
+                locked->waiters_.pop_front();
+            }
+
+            auto waiter(Make<Waiter>());
+            locked->waiters_.emplace_back(waiter);
+            return {true, std::move(waiter)};
+        }());
+
+        if (evicted != nullptr) {
+            ++evicted_;
+            evicted->ready_();
+        }
+
+        if (!joined.first)
+            ++dropped_;
+        else if (joined.second != nullptr)
+            ++waited_;
+        return joined;
+    }
+
   public:
-    Nest(unsigned limit = -1) :
+    Nest(unsigned limit = -1, Admission admission = Admission::Drop, size_t waiting = 0) :
+        admission_(admission),
+        waiting_(waiting),
         limit_(limit)
     {
         type_ = typeid(*this).name();
@@ -84,22 +194,93 @@ class Nest :
 
     task<void> Shut() noexcept override {
         limit_ = 0;
+
+        for (;;) {
+            auto waiter([&]() -> S<Waiter> {
+                const auto locked(locked_());
+                if (locked->waiters_.empty())
+                    return nullptr;
+                auto waiter(std::move(locked->waiters_.front()));
+                locked->waiters_.pop_front();
+                return waiter;
+            }());
+
+            if (waiter == nullptr)
+                break;
+            waiter->ready_();
+        }
+
         while (count_ != 0)
             co_await *event_;
         Valve::Stop();
         co_await Valve::Shut();
     }
 
+    // work that could not start right away and had to be queued
+    uint64_t Waited() const {
+        return waited_; }
+    // work that started (possibly after waiting)
+    uint64_t Hatched() const {
+        return hatched_; }
+    // work rejected outright, and work evicted from the queue by newer work
+    uint64_t Dropped() const {
+        return dropped_; }
+    uint64_t Evicted() const {
+        return evicted_; }
+
     template <typename Code_>
-    auto Hatch(Code_ code, const char *name) noexcept -> typename std::enable_if<noexcept(code()), bool>::type {
-        Count count(this);
-        if (count > limit_)
+    auto Hatch(Code_ code, const char *name, Priority priority = Priority::Control) noexcept -> typename std::enable_if<noexcept(code()), bool>::type {
+        if (admission_ == Admission::Drop) {
+            Count count(this);
+            if (count > limit_) {
+                ++dropped_;
+                return false;
+            }
+
+            ++hatched_;
+            Spawn([count = std::move(count), code = code()]() mutable noexcept -> task<void> {
+                orc_ignore({ co_await code(); });
+            }, name, priority);
+            return true;
+        }
+
+        auto [joined, waiter] = Join();
+        if (!joined)
             return false;
-        Spawn([count = std::move(count), code = code()]() mutable noexcept -> task<void> {
+
+        Spawn([this, waiter = std::move(waiter), code = code()]() mutable noexcept -> task<void> {
+            if (waiter != nullptr) {
+                co_await *waiter->ready_;
+                if (!waiter->admitted_)
+                    co_return;
+            }
+
+            Count count(this, 0);
+            ++hatched_;
             orc_ignore({ co_await code(); });
-        }, name);
+        }, name, priority);
         return true;
     }
+
+    // this is Hatch for coroutines: the caller, not the work, waits for room
+    template <typename Code_>
+    auto Admit(Code_ code, const char *name, Priority priority = Priority::Control) noexcept -> typename std::enable_if<noexcept(code()), task<bool>>::type {
+        const auto [joined, waiter] = Join();
+        if (!joined)
+            co_return false;
+
+        if (waiter != nullptr) {
+            co_await *waiter->ready_;
+            if (!waiter->admitted_)
+                co_return false;
+        }
+
+        ++hatched_;
+        Spawn([count = Count(this, 0), code = code()]() mutable noexcept -> task<void> {
+            orc_ignore({ co_await code(); });
+        }, name, priority);
+        co_return true;
+    }
 };
 
 }
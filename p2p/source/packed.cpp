@@ -0,0 +1,111 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include "packed.hpp"
+
+namespace orc {
+
+static size_t Length(Range &range, size_t size) {
+    orc_assert(size <= sizeof(uint32_t));
+    orc_assert(range.size() > size);
+    size_t value(0);
+    for (size_t i(1); i != size + 1; ++i)
+        value = value << 8 | range[i];
+    return value;
+}
+
+Packed Packed::Take(Range &range) {
+    orc_assert(range.size() != 0);
+    const auto data(range.data());
+    const auto first(data[0]);
+
+    bool scalar;
+    size_t header;
+    size_t length;
+
+    if (first < 0x80) {
+        range += 1;
+        return {true, Range(data, 1)};
+    } else if (first < 0xb8) {
+        scalar = true;
+        header = 1;
+        length = first - 0x80;
+    } else if (first < 0xc0) {
+        scalar = true;
+        header = 1 + first - 0xb7;
+        length = Length(range, first - 0xb7);
+    } else if (first < 0xf8) {
+        scalar = false;
+        header = 1;
+        length = first - 0xc0;
+    } else {
+        scalar = false;
+        header = 1 + first - 0xf7;
+        length = Length(range, first - 0xf7);
+    }
+
+    orc_assert(range.size() - header >= length);
+    range += header + length;
+    return {scalar, Range(data + header, length)};
+}
+
+Packed::Packed(const Range &range) :
+    Packed([&]() {
+        auto rest(range);
+        const auto packed(Take(rest));
+        orc_assert(rest.size() == 0);
+        return packed;
+    }())
+{
+}
+
+uint256_t Packed::num() const {
+    orc_assert(scalar_);
+    orc_assert(range_.size() <= 32);
+    uint256_t value(0);
+    if (range_.size() != 0)
+        boost::multiprecision::import_bits(value, std::reverse_iterator(range_.data() + range_.size()), std::reverse_iterator(range_.data()), 8, false);
+    return value;
+}
+
+size_t Packed::size() const {
+    size_t count(0);
+    each([&](const Packed &) {
+        ++count;
+    });
+    return count;
+}
+
+Packed Packed::operator [](unsigned i) const {
+    Packed value;
+    bool found(false);
+    each([&](const Packed &item) {
+        if (i-- == 0 && !found) {
+            value = item;
+            found = true;
+        }
+    });
+    orc_assert(found);
+    return value;
+}
+
+}
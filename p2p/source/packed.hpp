@@ -0,0 +1,96 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#ifndef ORCHID_PACKED_HPP
+#define ORCHID_PACKED_HPP
+
+#include <array>
+
+#include "buffer.hpp"
+#include "integer.hpp"
+
+namespace orc {
+
+// Packed is a view of an RLP item that was never Explode()d: it points
+// into the encoded data (which must outlive it) and never allocates
+
+class Packed {
+  private:
+    bool scalar_;
+    Range range_;
+
+  public:
+    Packed() :
+        scalar_(true),
+        range_(Nothing())
+    {
+    }
+
+    Packed(bool scalar, const Range &range) :
+        scalar_(scalar),
+        range_(range)
+    {
+    }
+
+    explicit Packed(const Range &range);
+
+    static Packed Take(Range &range);
+
+    bool scalar() const {
+        return scalar_;
+    }
+
+    const Range &range() const {
+        return range_;
+    }
+
+    Subset buf() const {
+        orc_assert(scalar_);
+        return Subset(range_);
+    }
+
+    uint256_t num() const;
+
+    template <typename Code_>
+    void each(Code_ &&code) const {
+        orc_assert(!scalar_);
+        for (auto rest(range_); rest.size() != 0; )
+            code(Take(rest));
+    }
+
+    template <size_t Size_>
+    size_t split(std::array<Packed, Size_> &items) const {
+        size_t count(0);
+        each([&](const Packed &item) {
+            orc_assert(count != Size_);
+            items[count++] = item;
+        });
+        return count;
+    }
+
+    size_t size() const;
+    Packed operator [](unsigned i) const;
+};
+
+}
+
+#endif//ORCHID_PACKED_HPP
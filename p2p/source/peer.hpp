@@ -132,6 +132,11 @@ orc_trace();
 };
 
 std::string Strip(const std::string &sdp);
+
+// an offer proposes one of our own features with an a=x-orchid- attribute,
+// and an answer agrees to it by repeating it; WebRTC ignores them both
+std::string Propose(std::string sdp, const char *feature);
+bool Proposed(const std::string &sdp, const char *feature);
 rtc::scoped_refptr<rtc::RTCCertificate> Certify();
 
 }
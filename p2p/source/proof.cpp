@@ -0,0 +1,102 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include <set>
+#include <vector>
+
+#include "keccak.hpp"
+#include "proof.hpp"
+
+namespace orc {
+
+Proof::Proof(const Json::Value &proof) {
+    std::set<std::string_view> seen;
+    std::vector<Beam> nodes;
+
+    const auto insert([&](const Json::Value &proofs) {
+        orc_assert(proofs.isArray());
+        for (const auto &node : proofs) {
+            const char *begin;
+            const char *end;
+            orc_assert(node.getString(&begin, &end));
+            const std::string_view text(begin, end - begin);
+            if (seen.emplace(text).second)
+                nodes.emplace_back(Bless(text));
+        }
+    });
+
+    insert(proof["accountProof"]);
+    for (const auto &storage : proof["storageProof"])
+        insert(storage["proof"]);
+
+    std::vector<const Region *> data;
+    data.reserve(nodes.size());
+    for (const auto &node : nodes)
+        data.emplace_back(&node);
+
+    std::vector<Brick<32>> hashes(nodes.size());
+    Hash(hashes.data(), data.data(), data.size());
+
+    for (size_t i(0); i != nodes.size(); ++i)
+        nodes_.try_emplace(hashes[i], std::move(nodes[i]));
+}
+
+Packed Proof::Verify(Brick<32> hash, const Region &path) const {
+    size_t offset(0);
+
+    // every step consumes a node; a well-formed path can't visit more
+    for (auto e(nodes_.size()), i(decltype(e)(0)); i != e; ++i) {
+        const auto node(nodes_.find(hash));
+        orc_assert_(node != nodes_.end(), "missing proof node " << hash);
+
+        std::array<Packed, 17> proof;
+        switch (Packed(node->second).split(proof)) {
+            case 17: {
+                if (offset == path.size() * 2)
+                    return Packed(proof[16].buf());
+                const auto data(proof[path.nib(offset++)].buf());
+                if (data.size() == 0)
+                    return Packed();
+                hash = Brick<32>(data);
+            } break;
+
+            case 2: {
+                const auto leg(proof[0].buf());
+                const auto type(leg.nib(0));
+                for (size_t i((type & 0x1) != 0 ? 1 : 2), e(leg.size() * 2); i != e; ++i)
+                    if (path.nib(offset++) != leg.nib(i))
+                        return Packed();
+                const auto range(proof[1].buf());
+                if ((type & 0x2) != 0)
+                    return Packed(range);
+                hash = Brick<32>(range);
+            } break;
+
+            default:
+                orc_assert(false);
+        }
+    }
+
+    orc_assert(false);
+}
+
+}
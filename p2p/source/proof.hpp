@@ -0,0 +1,56 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#ifndef ORCHID_PROOF_HPP
+#define ORCHID_PROOF_HPP
+
+#include <map>
+
+#include <json/json.h>
+
+#include "buffer.hpp"
+#include "packed.hpp"
+
+namespace orc {
+
+// all of the trie nodes from one eth_getProof response, indexed by hash: the
+// account and storage proofs share most of their upper nodes, so each node
+// is only decoded and hashed once, no matter how many keys walk through it
+
+class Proof {
+  private:
+    std::map<Brick<32>, Beam> nodes_;
+
+  public:
+    Proof(const Json::Value &proof);
+
+    size_t size() const {
+        return nodes_.size();
+    }
+
+    // the returned leaf points into this Proof
+    Packed Verify(Brick<32> hash, const Region &path) const;
+};
+
+}
+
+#endif//ORCHID_PROOF_HPP
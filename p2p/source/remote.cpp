@@ -20,7 +20,10 @@
 /* }}} */
 
 
+#include <algorithm>
 #include <queue>
+#include <tuple>
+#include <vector>
 
 #include <cppcoro/async_auto_reset_event.hpp>
 #include <cppcoro/async_manual_reset_event.hpp>
@@ -35,32 +38,32 @@
 
 #include <p2p/base/basic_packet_socket_factory.h>
 
+#include "datagram.hpp"
 #include "dns.hpp"
 #include "event.hpp"
 #include "locked.hpp"
 #include "lwip.hpp"
 #include "manager.hpp"
 #include "remote.hpp"
+#include "scope.hpp"
+#include "trace.hpp"
 
 #define orc_lwipcall(call, expr) ({ \
     const auto _status(call expr); \
     orc_assert_(_status == ERR_OK, "lwip " << #call << ": " << lwip_strerr(_status)); \
 _status; })
 
-extern "C" struct netif *hook_ip4_route_src(const ip4_addr_t *src, const ip4_addr_t *dest)
-{
-    if (src == nullptr)
-        return nullptr;
-    struct netif *netif;
-    NETIF_FOREACH(netif) {
-        if (netif_is_up(netif) && netif_is_link_up(netif) && ip4_addr_cmp(src, netif_ip4_addr(netif))) {
-            return netif;
-        }
-    }
-    return nullptr;
+namespace orc {
+
+static size_t holds_(0);
+
+void Holds(size_t size) {
+    holds_ = size;
 }
 
-namespace orc {
+size_t Holds() {
+    return holds_;
+}
 
 class Reference {
   private:
@@ -112,7 +115,9 @@ class Chain :
     Reference buffer_;
 
   public:
-    // XXX: this always copies, but sometimes I could pbuf_ref? ugh
+    Chain() = default;
+
+    // this copies, as tcpip_inpkt queues what it is given
     Chain(const Buffer &data) :
         buffer_(pbuf_alloc(PBUF_RAW, data.size(), PBUF_RAM))
     {
@@ -139,7 +144,13 @@ class Chain :
         return std::move(buffer_).Tear();
     }
 
+    size_t size() const override {
+        return buffer_ == nullptr ? 0 : buffer_->tot_len;
+    }
+
     bool each(const std::function<bool (const uint8_t *, size_t)> &code) const override {
+        if (buffer_ == nullptr)
+            return true;
         for (pbuf *buffer(buffer_); ; buffer = buffer->next) {
             orc_assert(buffer != nullptr);
             if (!code(static_cast<const uint8_t *>(buffer->payload), buffer->len))
@@ -153,9 +164,20 @@ class Chain :
 };
 
 class Core {
-  public:
-    Core() {
+  private:
+    Traced held_;
+
+    // held_ only starts once this returns, so the wait isn't counted as held
+    static const char *Lock() {
+        Traced traced("lwip lock");
         sys_lock_tcpip_core();
+        return "lwip core";
+    }
+
+  public:
+    Core() :
+        held_(Lock())
+    {
     }
 
     ~Core() {
@@ -163,39 +185,57 @@ class Core {
     }
 };
 
+// UDP skips lwIP: Remote::Land hands a RemoteCommon what arrives for its
+// port, and it writes the headers of what it sends itself; its pcb holds
+// that port, so none of lwIP's (say, WebRTC's) sockets can take it, and
+// receives the fragmented datagrams that lwIP had to reassemble
 class RemoteCommon {
+    friend class Remote;
+
   protected:
+    Remote &remote_;
     udp_pcb *pcb_;
+    Socket local_;
 
     virtual void Land(const Buffer &data, const Socket &socket) = 0;
 
-    RemoteCommon(const ip4_addr_t &host) {
+    task<void> Send(const Buffer &data, const Socket &socket) {
+        co_return co_await remote_.Inner().Send(Datagram(local_, socket, data));
+    }
+
+    RemoteCommon(Remote &remote, const ip4_addr_t &host) :
+        remote_(remote)
+    {
         Core core;
         pcb_ = udp_new();
         orc_assert(pcb_ != nullptr);
         orc_lwipcall(udp_bind, (pcb_, &host, 0));
+        local_ = Socket(pcb_->local_ip, pcb_->local_port);
+
+        udp_recv(pcb_, [](void *arg, udp_pcb *pcb, pbuf *data, const ip4_addr_t *host, u16_t port) noexcept {
+            const auto self(static_cast<RemoteCommon *>(arg));
+            // as with Remote::Land, this only lands between Open and Shut
+            { const auto locked(self->remote_.udps_());
+                const auto udp(locked->find(self->local_.Port()));
+                if (udp != locked->end() && udp->second == self)
+                    self->Land(Chain(data), Socket(*host, port)); }
+            pbuf_free(data);
+        }, this);
     }
 
     ~RemoteCommon() {
+        Shut();
         Core core;
         udp_remove(pcb_);
     }
 
   public:
-    operator udp_pcb *() {
-        return pcb_;
-    }
-
-    void Open(const Core &core) {
-        udp_recv(pcb_, [](void *arg, udp_pcb *pcb, pbuf *data, const ip4_addr_t *host, u16_t port) noexcept {
-            static_cast<RemoteCommon *>(arg)->Land(Chain(data), Socket(*host, port));
-            pbuf_free(data);
-        }, this);
+    void Open() {
+        orc_insist(remote_.udps_()->emplace(local_.Port(), this).second);
     }
 
     void Shut() noexcept {
-        Core core;
-        udp_disconnect(pcb_);
+        remote_.udps_()->erase(local_.Port());
     }
 };
 
@@ -203,22 +243,26 @@ class RemoteAssociation :
     public Pump<Buffer>,
     public RemoteCommon
 {
+  private:
+    Socket endpoint_;
+
   protected:
     void Land(const Buffer &data, const Socket &socket) override {
-        Pump::Land(data);
+        // as a connected pcb did, this drops what comes from anywhere else
+        if (socket == endpoint_)
+            Pump::Land(data);
     }
 
   public:
-    RemoteAssociation(BufferDrain &drain, const ip4_addr_t &host) :
+    RemoteAssociation(BufferDrain &drain, Remote &remote, const ip4_addr_t &host) :
         Pump(drain),
-        RemoteCommon(host)
+        RemoteCommon(remote, host)
     {
     }
 
-    void Open(const ip4_addr_t &host, uint16_t port) {
-        Core core;
-        RemoteCommon::Open(core);
-        orc_lwipcall(udp_connect, (pcb_, &host, port));
+    void Open(const Socket &endpoint) {
+        endpoint_ = endpoint;
+        RemoteCommon::Open();
     }
 
     task<void> Shut() noexcept override {
@@ -228,9 +272,7 @@ class RemoteAssociation :
     }
 
     task<void> Send(const Buffer &data) override {
-        Core core;
-        orc_lwipcall(udp_send, (pcb_, Chain(data)));
-        co_return;
+        co_return co_await RemoteCommon::Send(data, endpoint_);
     }
 };
 
@@ -244,19 +286,18 @@ class RemoteOpening :
     }
 
   public:
-    RemoteOpening(BufferSewer &drain, const ip4_addr_t &host) :
+    RemoteOpening(BufferSewer &drain, Remote &remote, const ip4_addr_t &host) :
         Opening(drain),
-        RemoteCommon(host)
+        RemoteCommon(remote, host)
     {
     }
 
     Socket Local() const override {
-        return Socket(pcb_->local_ip, pcb_->local_port);
+        return local_;
     }
 
     void Open() {
-        Core core;
-        RemoteCommon::Open(core);
+        RemoteCommon::Open();
     }
 
     task<void> Shut() noexcept override {
@@ -266,10 +307,7 @@ class RemoteOpening :
     }
 
     task<void> Send(const Buffer &data, const Socket &socket) override {
-        ip4_addr_t address(socket.Host());
-        Core core;
-        orc_lwipcall(udp_sendto, (pcb_, Chain(data), &address, socket.Port()));
-        co_return;
+        co_return co_await RemoteCommon::Send(data, socket);
     }
 };
 
@@ -277,9 +315,15 @@ class RemoteConnection final :
     public Stream
 {
   private:
+    Remote &remote_;
+
     tcp_pcb *pcb_;
     Transfer<err_t> opened_;
 
+    // these are only touched with the core locked
+    uint64_t written_ = 0;
+    uint64_t acked_ = 0;
+
     cppcoro::async_mutex send_;
     cppcoro::async_manual_reset_event sent_;
 
@@ -287,13 +331,15 @@ class RemoteConnection final :
 
     struct Locked_ {
         std::exception_ptr error_;
-        std::queue<Beam> data_;
+        // these are held, rather than copied, until Read (which also only
+        // then reopens the window, so there's never more than TCP_WND here)
+        std::queue<Chain> data_;
         size_t offset_ = 0;
     }; Locked<Locked_> locked_;
 
   protected:
-    void Land(const Buffer &data) {
-        locked_()->data_.emplace(data);
+    void Land(Chain data) {
+        locked_()->data_.emplace(std::move(data));
         read_.set();
     }
 
@@ -301,12 +347,14 @@ class RemoteConnection final :
         if (error != nullptr)
             locked_()->error_ = error;
         else
-            locked_()->data_.emplace(Beam());
+            locked_()->data_.emplace();
         read_.set();
     }
 
   public:
-    RemoteConnection(const ip4_addr_t &host) {
+    RemoteConnection(Remote &remote, const ip4_addr_t &host) :
+        remote_(remote)
+    {
         Core core;
         pcb_ = tcp_new();
         orc_assert(pcb_ != nullptr);
@@ -322,38 +370,44 @@ class RemoteConnection final :
     }
 
     task<size_t> Read(Beam &buffer) override {
-        auto data(buffer.data());
-        auto size(buffer.size());
+        const auto data(buffer.data());
+        const auto size(buffer.size());
         orc_insist(size != 0);
 
         for (;; co_await read_, co_await Schedule()) {
+            // Land is called with the core locked, so it must be taken first
+            Core core;
             const auto locked(locked_());
             if (!locked->data_.empty()) {
                 size_t writ(0);
 
-              next:
-                const auto &next(locked->data_.front());
-                const auto base(next.data());
-                const auto rest(next.size() - locked->offset_);
-                if (rest == 0)
-                    co_return 0;
-
-                const auto have(std::min(size, rest));
-                Copy(data, base + locked->offset_, have);
-                writ += have;
-
-                if (rest != have)
-                    locked->offset_ += have;
-                else {
-                    locked->data_.pop();
-                    locked->offset_ = 0;
-                    if (size != have && !locked->data_.empty()) {
-                        data += have;
-                        size -= have;
-                        goto next;
+                do {
+                    const auto &next(locked->data_.front());
+                    const auto rest(next.size() - locked->offset_);
+                    // the end comes after whatever was read already
+                    if (rest == 0)
+                        break;
+
+                    const auto have(std::min(size - writ, rest));
+                    orc_insist(pbuf_copy_partial(next, data + writ, u16_t(have), u16_t(locked->offset_)) == have);
+                    copied_ += have;
+                    writ += have;
+
+                    if (rest != have)
+                        locked->offset_ += have;
+                    else {
+                        locked->data_.pop();
+                        locked->offset_ = 0;
+                    }
+                } while (writ != size && !locked->data_.empty());
+
+                if (pcb_ != nullptr)
+                    for (auto rest(writ); rest != 0; ) {
+                        // with window scaling, this can be more than 16 bits
+                        const auto have(std::min<size_t>(rest, 0xffff));
+                        tcp_recved(pcb_, u16_t(have));
+                        rest -= have;
                     }
-                }
-
                 co_return writ;
             } else if (locked->error_ != nullptr)
                 std::rethrow_exception(locked->error_);
@@ -370,9 +424,7 @@ class RemoteConnection final :
                 if (data == nullptr)
                     self->Stop(nullptr);
                 else {
-                    const Chain chain(data);
-                    self->Land(chain);
-                    tcp_recved(pcb, chain.size());
+                    self->Land(Chain(data));
                     pbuf_free(data);
                 }
 
@@ -397,11 +449,11 @@ class RemoteConnection final :
                 }
             });
 
-            // XXX: I feel like I should be verifying that size covered the entire sent packet
             tcp_sent(pcb_, [](void *arg, tcp_pcb *pcb, u16_t size) noexcept -> err_t { orc_head
                 const auto self(static_cast<RemoteConnection *>(arg));
                 orc_insist(pcb == self->pcb_);
 
+                self->acked_ += size;
                 self->sent_.set();
                 return ERR_OK;
             });
@@ -433,45 +485,130 @@ class RemoteConnection final :
         Window window(data);
         auto rest(window.size());
 
-        goto start; do {
-            co_await sent_;
-            co_await Schedule();
+        // lwIP can reference what this was sent, rather than copy it, if this
+        // doesn't return until it was acknowledged (and no longer lent)
+        const auto hold(holds_ != 0 && rest >= holds_);
+        std::exception_ptr error;
 
-          start:
-            Core core;
-            orc_assert(pcb_ != nullptr);
+        try {
+            goto start; do {
+                co_await sent_;
+                co_await Schedule();
+
+              start:
+                Core core;
+                orc_assert(pcb_ != nullptr);
+
+                const auto need(tcp_sndbuf(pcb_));
+                if (need == 0) {
+                    sent_.reset();
+                    continue;
+                }
+
+                window.Take(std::min<size_t>(rest, need), [&](const uint8_t *data, size_t size) {
+                    // XXX: this can't actually happen as need is a uint16_t, but for type safety...
+                    if (size > 0xffff)
+                        size = 0xffff;
+                    rest -= size;
+
+                    u8_t flags(hold ? 0 : TCP_WRITE_FLAG_COPY);
+                    if (rest != 0)
+                        flags |= TCP_WRITE_FLAG_MORE;
+                    orc_lwipcall(tcp_write, (pcb_, data, size, flags));
+                    if (!hold)
+                        copied_ += size;
+                    written_ += size;
+                    return size;
+                });
+            } while (rest != 0);
+        } catch (...) {
+            error = std::current_exception();
+        }
 
-            const auto need(tcp_sndbuf(pcb_));
-            if (need == 0) {
+        // if this failed, lwIP let go of what it had, but it might still be lent
+        bool lost(false);
+        if (hold) {
+            uint64_t lent;
+            for (;; co_await sent_, co_await Schedule()) {
+                Core core;
+                if (pcb_ == nullptr || acked_ >= written_) {
+                    lost = pcb_ == nullptr;
+                    lent = remote_.Lent();
+                    break;
+                }
                 sent_.reset();
-                continue;
             }
+            co_await remote_.Returned(lent);
+        }
 
-            window.Take(std::min<size_t>(rest, need), [&](const uint8_t *data, size_t size) {
-                // XXX: this can't actually happen as need is a uint16_t, but for type safety...
-                if (size > 0xffff)
-                    size = 0xffff;
-                rest -= size;
-
-                // XXX: consider avoiding copies by holding the buffer until send completes
-                u8_t flags(TCP_WRITE_FLAG_COPY);
-                if (rest != 0)
-                    flags |= TCP_WRITE_FLAG_MORE;
-                orc_lwipcall(tcp_write, (pcb_, data, size, flags));
-                copied_ += size;
-                return size;
-            });
-        } while (rest != 0);
+        if (error != nullptr)
+            std::rethrow_exception(error);
+        orc_assert_(!lost, "connection lost before its data was acknowledged");
     }
 };
 
+uint64_t Remote::Lend() {
+    const auto locked(lending_());
+    const auto lend(locked->next_++);
+    locked->lent_.emplace(lend);
+    return lend;
+}
+
+void Remote::Return(uint64_t lend) {
+    std::vector<S<Event>> returned;
+    { const auto locked(lending_());
+        locked->lent_.erase(lend);
+        const auto low(locked->lent_.empty() ? locked->next_ : *locked->lent_.begin());
+        const auto end(locked->waiting_.upper_bound(low));
+        for (auto waiting(locked->waiting_.begin()); waiting != end; ++waiting)
+            returned.emplace_back(std::move(waiting->second));
+        locked->waiting_.erase(locked->waiting_.begin(), end); }
+    for (const auto &event : returned)
+        (*event)();
+}
+
+uint64_t Remote::Lent() {
+    return lending_()->next_;
+}
+
+task<void> Remote::Returned(uint64_t lent) {
+    const auto event(Make<Event>());
+    { const auto locked(lending_());
+        const auto low(locked->lent_.empty() ? locked->next_ : *locked->lent_.begin());
+        if (low >= lent)
+            co_return;
+        locked->waiting_.emplace(lent, event); }
+    co_await **event;
+}
+
 void Remote::Send(pbuf *buffer) {
-    // XXX: this always copies the data, but I should sometimes be able to reference it
-    // to do this, I think I need to check if !PBUF_NEEDS_COPY _recursively_ for queue?
-    nest_.Hatch([&]() noexcept { return [this, data = Beam(Chain(buffer))]() -> task<void> {
-        //Log() << "Remote <<< " << this << " " << data << std::endl;
-        co_return co_await Inner().Send(data);
-    }; }, __FUNCTION__);
+    // an output may hold on to a pbuf, as long as nothing in its chain is
+    // volatile: TCP's segments are not (and it won't retransmit one while
+    // this holds it), but anything that is (PBUF_REF) gets copied; a held
+    // send's data isn't lwIP's (PBUF_ROM), so gets tracked as a lend
+    bool copy(false);
+    bool lend(false);
+    for (auto next(buffer); next != nullptr; next = next->next)
+        if (PBUF_NEEDS_COPY(next)) {
+            copy = true;
+            break;
+        } else if (pbuf_get_allocsrc(next) == PBUF_TYPE_ALLOC_SRC_MASK_STD_MEMP_PBUF)
+            lend = true;
+
+    if (copy)
+        nest_.Hatch([&]() noexcept { return [this, data = Beam(Chain(buffer))]() -> task<void> {
+            //Log() << "Remote <<< " << this << " " << data << std::endl;
+            co_return co_await Inner().Send(data);
+        }; }, __FUNCTION__, Priority::Data);
+    else if (!lend)
+        nest_.Hatch([&]() noexcept { return [this, data = Chain(buffer)]() -> task<void> {
+            co_return co_await Inner().Send(data);
+        }; }, __FUNCTION__, Priority::Data);
+    else
+        nest_.Hatch([&]() noexcept { return [this, data = Chain(buffer), lend = Lend()]() -> task<void> {
+            _scope({ Return(lend); });
+            co_return co_await Inner().Send(data);
+        }; }, __FUNCTION__, Priority::Data);
 }
 
 err_t Remote::Output(netif *interface, pbuf *buffer, const ip4_addr_t *destination) {
@@ -486,15 +623,143 @@ err_t Remote::Initialize(netif *interface) {
     return ERR_OK;
 }
 
+static void Setup() {
+    static bool setup(false);
+    if (!setup) {
+        tcpip_init(nullptr, nullptr);
+        setup = true;
+    }
+}
+
+static Subnet subnets_;
+
+void Subnets(const Subnet &subnet) {
+    // 4 reserved addresses, a host, and the broadcast need at least a /29
+    orc_assert(subnet.bits_ >= 8 && subnet.bits_ <= 29);
+    orc_assert((uint32_t(subnet.network_) & ~(~uint32_t(0) << (32 - subnet.bits_))) == 0);
+    subnets_ = subnet;
+}
+
+Subnet Subnets() {
+    return subnets_;
+}
+
+// the hosts Remotes have, as a bitmap so the lowest free one is found a word
+// at a time, and their interfaces by host, which is what hook_ip4_route_src
+// looks a source up in; all of this is guarded by lwIP's core lock
+class Pool {
+  private:
+    // the network, gateway, and the two addresses a device uses (10.7.0.3)
+    static const uint64_t Reserved_ = 0xf;
+
+    uint32_t network_ = 0;
+    unsigned bits_ = 32;
+    size_t claimed_ = 0;
+
+    size_t next_ = 0;
+    std::vector<uint64_t> used_;
+    std::vector<netif *> interfaces_;
+
+    size_t Index(const class Host &host) const {
+        // this wraps hosts before network_ to beyond interfaces_
+        return uint32_t(host) - network_;
+    }
+
+    // whether this is a host that Claim() handed out and hasn't taken back
+    bool Claimed(size_t index) const {
+        if (index >= size_t(1) << (32 - bits_) || index / 64 >= used_.size())
+            return false;
+        if (index < 64 && (Reserved_ >> index & 1) != 0)
+            return false;
+        return (used_[index / 64] >> index % 64 & 1) != 0;
+    }
+
+  public:
+    class Host Claim() {
+        if (claimed_ == 0) {
+            const auto subnet(Subnets());
+            network_ = subnet.network_;
+            bits_ = subnet.bits_;
+            next_ = 0;
+            used_.clear();
+            interfaces_.clear();
+        }
+
+        for (;; ++next_) {
+            if (next_ == used_.size())
+                used_.emplace_back(next_ == 0 ? Reserved_ : 0);
+            const auto free(~used_[next_]);
+            if (free == 0)
+                continue;
+            const size_t index(next_ * 64 + __builtin_ctzll(free));
+            // the last address of the subnet is its broadcast
+            orc_assert_(index < (size_t(1) << (32 - bits_)) - 1, "no hosts left in " << Host(network_) << "/" << bits_);
+            used_[next_] |= uint64_t(1) << index % 64;
+            ++claimed_;
+            return Host(uint32_t(network_ + index));
+        }
+    }
+
+    void Release(const class Host &host) {
+        const auto index(Index(host));
+        if (!Claimed(index))
+            return;
+        used_[index / 64] &= ~(uint64_t(1) << index % 64);
+        next_ = std::min(next_, index / 64);
+        --claimed_;
+        if (index < interfaces_.size())
+            interfaces_[index] = nullptr;
+    }
+
+    void Enroll(const class Host &host, netif *interface) {
+        const auto index(Index(host));
+        if (!Claimed(index))
+            return;
+        if (index >= interfaces_.size())
+            interfaces_.resize(index + 1, nullptr);
+        interfaces_[index] = interface;
+    }
+
+    netif *Find(const class Host &host) const {
+        const auto index(Index(host));
+        return index < interfaces_.size() ? interfaces_[index] : nullptr;
+    }
+
+    ip4_addr_t Gateway() const {
+        return Host(network_ + 1);
+    }
+
+    ip4_addr_t Netmask() const {
+        return Host(~uint32_t(0) << (32 - bits_));
+    }
+};
+
+static Pool pool_;
+
 void Remote::Land(const Buffer &data) {
     //Log() << "Remote >>> " << this << " " << data << std::endl;
-    orc_ignore({ orc_assert(tcpip_inpkt(Chain(data).Tear(), &interface_, interface_.input) == ERR_OK); });
+    bool landed(false);
+    orc_ignore({ landed = Datagram(data, [&](const Socket &source, const Socket &destination, const Buffer &data) {
+        if (destination.Host() != host_)
+            return false;
+        // this is held while landing, as the core lock was for udp_recv
+        const auto locked(udps_());
+        const auto udp(locked->find(destination.Port()));
+        if (udp == locked->end())
+            return false;
+        udp->second->Land(data, source);
+        return true;
+    }); });
+    if (!landed)
+        orc_ignore({ orc_assert(tcpip_inpkt(Chain(data).Tear(), &interface_, interface_.input) == ERR_OK); });
 }
 
 void Remote::Stop(const std::string &error) noexcept {
     netifapi_netif_set_link_down(&interface_);
     netifapi_netif_set_down(&interface_);
     netifapi_netif_remove(&interface_);
+    { Core core;
+        pool_.Release(host_); }
     Origin::Stop();
 }
 
@@ -502,23 +767,26 @@ Remote::Remote(const class Host &host) :
     Origin(std::make_unique<Assistant>(host)),
     host_(host)
 {
-    static bool setup(false);
-    if (!setup) {
-        tcpip_init(nullptr, nullptr);
-        setup = true;
-    }
+    Setup();
 
-    ip4_addr_t gateway; IP4_ADDR(&gateway, 10,7,0,1);
-    ip4_addr_t address(host_);
-    ip4_addr_t netmask; IP4_ADDR(&netmask, 255,255,255,0);
+    const auto [gateway, netmask] = []() {
+        Core core;
+        return std::make_tuple(pool_.Gateway(), pool_.Netmask());
+    }();
 
+    ip4_addr_t address(host_);
     orc_assert(netifapi_netif_add(&interface_, &address, &netmask, &gateway, this, &Initialize, &ip_input) == ERR_OK);
-}
 
-static uint8_t quad_(3);
+    Core core;
+    pool_.Enroll(host_, &interface_);
+}
 
 Remote::Remote() :
-    Remote({10,7,0,++quad_})
+    Remote([]() {
+        Setup();
+        Core core;
+        return pool_.Claim();
+    }())
 {
     type_ = typeid(*this).name();
 }
@@ -559,21 +827,31 @@ rtc::BasicPacketSocketFactory &Remote::Factory() {
 }
 
 task<void> Remote::Associate(BufferSunk &sunk, const Socket &endpoint) {
-    auto &association(sunk.Wire<RemoteAssociation>(host_));
-    association.Open(endpoint.Host(), endpoint.Port());
+    auto &association(sunk.Wire<RemoteAssociation>(*this, host_));
+    association.Open(endpoint);
     co_return;
 }
 
 task<Socket> Remote::Unlid(Sunk<BufferSewer, Opening> &sunk) {
-    auto &opening(sunk.Wire<RemoteOpening>(host_));
+    auto &opening(sunk.Wire<RemoteOpening>(*this, host_));
     opening.Open();
     co_return opening.Local();
 }
 
 task<U<Stream>> Remote::Connect(const Socket &endpoint) {
-    auto connection(std::make_unique<RemoteConnection>(host_));
+    auto connection(std::make_unique<RemoteConnection>(*this, host_));
     co_await connection->Open(endpoint.Host(), endpoint.Port());
     co_return connection;
 }
 
 }
+
+extern "C" struct netif *hook_ip4_route_src(const ip4_addr_t *src, const ip4_addr_t *dest)
+{
+    if (src == nullptr)
+        return nullptr;
+    const auto netif(orc::pool_.Find(*src));
+    if (netif != nullptr && netif_is_up(netif) && netif_is_link_up(netif) && ip4_addr_cmp(src, netif_ip4_addr(netif)))
+        return netif;
+    return nullptr;
+}
@@ -23,14 +23,38 @@
 #ifndef ORCHID_REMOTE_HPP
 #define ORCHID_REMOTE_HPP
 
+#include <map>
+#include <set>
+
 #include <lwip/netif.h>
 
+#include "event.hpp"
+#include "locked.hpp"
 #include "nest.hpp"
 #include "origin.hpp"
 #include "socket.hpp"
 
 namespace orc {
 
+class RemoteCommon;
+
+// a RemoteConnection has lwIP reference, rather than copy, sends at least this
+// big, which then only return once they were acknowledged (0 never does this)
+void Holds(size_t size);
+size_t Holds();
+
+// each Remote's interface gets a host from this subnet, lowest free first; its
+// first four addresses (the gateway, and those a device uses) are not handed
+// out, and a host is reused once the Remote that had it has stopped
+struct Subnet {
+    class Host network_ = Host(10, 7, 0, 0);
+    unsigned bits_ = 16;
+};
+
+// this is used whenever no Remote has a host, so before the first one
+void Subnets(const Subnet &subnet);
+Subnet Subnets();
+
 class Remote :
     public Origin,
     public BufferDrain,
@@ -42,6 +66,25 @@ class Remote :
 
     netif interface_;
 
+    // UDP to host_ skips lwIP: these are what each port lands on
+    friend class RemoteCommon;
+    Locked<std::map<uint16_t, RemoteCommon *>> udps_;
+
+    // a held send's segments might still be lent to Inner() (if they were
+    // retransmitted) after being acknowledged, so each lend gets a serial,
+    // and its RemoteConnection waits for every lend before that to return
+    struct Lending_ {
+        uint64_t next_ = 0;
+        std::set<uint64_t> lent_;
+        std::multimap<uint64_t, S<Event>> waiting_;
+    }; Locked<Lending_> lending_;
+
+    friend class RemoteConnection;
+    uint64_t Lend();
+    void Return(uint64_t lend);
+    uint64_t Lent();
+    task<void> Returned(uint64_t lent);
+
     void Send(pbuf *buffer);
     static err_t Output(netif *interface, pbuf *buffer, const ip4_addr_t *destination);
     static err_t Initialize(netif *interface);
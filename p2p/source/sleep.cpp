@@ -20,15 +20,18 @@
 /* }}} */
 
 
-#include <asio.hpp>
-#include "baton.hpp"
 #include "sleep.hpp"
+#include "spawn.hpp"
+#include "wheel.hpp"
 
 namespace orc {
 
 task<void> Sleep(unsigned milliseconds) noexcept {
-    boost::asio::deadline_timer timer(Context(), boost::posix_time::milliseconds(milliseconds));
-    co_await timer.async_wait(Token());
+    // the wheel's thread only drives timers, so hop back onto the pool at the same priority
+    auto resume(Schedule());
+    Alarm alarm(milliseconds);
+    co_await alarm;
+    co_await resume;
 }
 
 }
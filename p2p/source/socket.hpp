@@ -25,6 +25,7 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/endian/conversion.hpp>
@@ -380,4 +381,32 @@ inline std::ostream &operator <<(std::ostream &out, const Three &three) {
 
 }
 
+namespace std {
+
+template <>
+struct hash<orc::Host> {
+    size_t operator ()(const orc::Host &host) const {
+        const auto address(host.operator in6_addr());
+        return hash<string_view>()(string_view(reinterpret_cast<const char *>(address.s6_addr), sizeof(address.s6_addr)));
+    }
+};
+
+template <>
+struct hash<orc::Socket> {
+    size_t operator ()(const orc::Socket &socket) const {
+        const auto value(hash<orc::Host>()(socket.Host()));
+        return value ^ (socket.Port() + 0x9e3779b9 + (value << 6) + (value >> 2));
+    }
+};
+
+template <>
+struct hash<orc::Four> {
+    size_t operator ()(const orc::Four &four) const {
+        const auto value(hash<orc::Socket>()(four.Source()));
+        return value ^ (hash<orc::Socket>()(four.Target()) + 0x9e3779b9 + (value << 6) + (value >> 2));
+    }
+};
+
+}
+
 #endif//ORCHID_SOCKET_HPP
@@ -20,68 +20,246 @@
 /* }}} */
 
 
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
 #include <thread>
-
-#include <cppcoro/detail/lightweight_manual_reset_event.hpp>
+#include <vector>
 
 #include <rtc_base/thread.h>
 
 #include "error.hpp"
+#include "shared.hpp"
 #include "spawn.hpp"
+#include "trace.hpp"
 
 namespace orc {
 
-// XXX: audit and correct the std::atomic usage in Pool
-// XXX: this should be a priority / deadline scheduler
+static uint64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// how long queued work of each class may be passed over for higher classes
+static const uint64_t Starve[Priorities] = {0, 5000000, 50000000};
+
+// Pool runs scheduled coroutines on a fixed set of worker threads. Each
+// worker has its own FIFO queue per Priority: work scheduled from a worker
+// stays on it, work scheduled from any other thread is dealt out round
+// robin, and idle workers steal from their neighbors before sleeping.
 
 class Pool {
   private:
-    std::atomic<Stacked *> stack_ = nullptr;
-    cppcoro::detail::lightweight_manual_reset_event ready_;
+    class Worker {
+      private:
+        std::mutex mutex_;
+        Stacked *heads_[Priorities] = {};
+        Stacked *tails_[Priorities] = {};
 
-  public:
-    void Drain() {
-        for (;;) {
-            auto stacked(stack_.load()); do {
-                if (stacked == nullptr)
-                    return;
-            } while (!stack_.compare_exchange_strong(stacked, stacked->next_));
-            stacked->code_.resume();
+      public:
+        void Push(Stacked *stacked) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (stacked != nullptr) {
+                const auto next(stacked->next_);
+                stacked->next_ = nullptr;
+                const auto priority(size_t(stacked->priority_));
+                if (tails_[priority] == nullptr)
+                    heads_[priority] = stacked;
+                else
+                    tails_[priority]->next_ = stacked;
+                tails_[priority] = stacked;
+                stacked = next;
+            }
         }
+
+        Stacked *Pop(uint64_t now) {
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            auto priority([&]() {
+                // the oldest item of a class that has waited too long goes first
+                for (auto priority(Priorities - 1); priority != 0; --priority)
+                    if (const auto head = heads_[priority])
+                        if (now - head->stamp_ > Starve[priority])
+                            return priority;
+                for (size_t priority(0); priority != Priorities; ++priority)
+                    if (heads_[priority] != nullptr)
+                        return priority;
+                return Priorities;
+            }());
+
+            if (priority == Priorities)
+                return nullptr;
+
+            const auto stacked(heads_[priority]);
+            heads_[priority] = stacked->next_;
+            if (heads_[priority] == nullptr)
+                tails_[priority] = nullptr;
+            stacked->next_ = nullptr;
+            return stacked;
+        }
+    };
+
+    struct Delays_ {
+        std::atomic<uint64_t> count_ = 0;
+        std::atomic<uint64_t> total_ = 0;
+        std::atomic<uint64_t> maximum_ = 0;
+    } delays_[Priorities];
+
+    std::vector<U<Worker>> workers_;
+
+    std::atomic<size_t> pending_ = 0;
+    std::atomic<unsigned> idle_ = 0;
+    std::atomic<unsigned> next_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+
+    static thread_local Worker *local_;
+
+    void Account(const Stacked *stacked, uint64_t now) {
+        auto &delays(delays_[size_t(stacked->priority_)]);
+        const auto delay(now - stacked->stamp_);
+        delays.count_.fetch_add(1, std::memory_order_relaxed);
+        delays.total_.fetch_add(delay, std::memory_order_relaxed);
+        auto maximum(delays.maximum_.load(std::memory_order_relaxed));
+        while (delay > maximum && !delays.maximum_.compare_exchange_weak(maximum, delay, std::memory_order_relaxed));
     }
 
-    void Run() {
+    Stacked *Take(size_t index) {
+        const auto now(Now());
+        const auto count(workers_.size());
+        for (size_t i(0); i != count; ++i)
+            if (const auto stacked = workers_[(index + i) % count]->Pop(now)) {
+                --pending_;
+                Account(stacked, now);
+                return stacked;
+            }
+        return nullptr;
+    }
+
+    void Run(size_t index) {
+        rtc::ThreadManager::Instance()->WrapCurrentThread();
+        local_ = workers_[index].get();
+
         for (;;) {
-            ready_.reset();
-            Drain();
-            ready_.wait();
+            if (const auto stacked = Take(index)) {
+                current_ = stacked->priority_;
+                Traced traced(Name(current_));
+                Arrive("schedule", stacked->flow_);
+#ifdef ORC_FIBER
+                // stacked lives in the coroutine's frame, which the resume might destroy
+                const auto fiber(stacked->fiber_);
+                const auto start(Fiber::Enter(fiber));
+                stacked->code_.resume();
+                Fiber::Leave(fiber, start);
+#else
+                stacked->code_.resume();
+#endif
+                continue;
+            }
+
+            // Stack() bumps pending_ before checking idle_, and we bump idle_
+            // before checking pending_ (under mutex_), so a wakeup can't slip
+            std::unique_lock<std::mutex> lock(mutex_);
+            ++idle_;
+            if (pending_ == 0)
+                ready_.wait(lock);
+            --idle_;
         }
     }
 
+  public:
+    static thread_local Priority current_;
+
+    Pool(unsigned count) {
+        orc_assert(count != 0);
+        for (unsigned i(0); i != count; ++i)
+            workers_.emplace_back(std::make_unique<Worker>());
+        for (unsigned i(0); i != count; ++i)
+            std::thread([this, i]() {
+                Run(i);
+            }).detach();
+    }
+
+    // this is usually one coroutine, but can be a chain (through next_)
     void Stack(Stacked *stacked) noexcept {
-        orc_insist(stacked->next_ == nullptr);
+        const auto now(Now());
+        size_t count(0);
+        for (auto next(stacked); next != nullptr; next = next->next_) {
+            next->stamp_ = now;
+            ++count;
+        }
+
+        if (count == 0)
+            return;
+
+        // counted before it can be popped, so Take() never drives this below 0
+        pending_ += count;
 
-        auto stack(stack_.load()); do {
-            stacked->next_ = stack;
-        } while (!stack_.compare_exchange_strong(stack, stacked));
+        auto worker(local_);
+        if (worker == nullptr)
+            worker = workers_[next_++ % workers_.size()].get();
+        worker->Push(stacked);
 
-        ready_.set();
+        if (idle_ != 0) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (count == 1)
+                ready_.notify_one();
+            else
+                ready_.notify_all();
+        }
+    }
+
+    Delay Delayed(Priority priority) const {
+        const auto &delays(delays_[size_t(priority)]);
+        return {delays.count_.load(), delays.total_.load(), delays.maximum_.load()};
     }
 };
 
+thread_local Pool::Worker *Pool::local_(nullptr);
+thread_local Priority Pool::current_(Priority::Control);
+
+static std::atomic<unsigned> workers_(1);
+static std::atomic<bool> started_(false);
+
+void Workers(unsigned count) {
+    orc_assert_(!started_, "Workers() must be called before the first Schedule()");
+    workers_ = count;
+}
+
 void Scheduled::await_suspend(std::experimental::coroutine_handle<> code) noexcept {
+    orc_insist(next_ == nullptr);
     code_ = code;
+    flow_ = Depart("schedule");
     pool_->Stack(this);
 }
 
+static Pool *Get() {
+    // this is leaked on purpose: the workers never stop, even during exit
+    static const auto pool(new Pool([]() {
+        started_ = true;
+        const unsigned count(workers_);
+        if (count != 0)
+            return count;
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }()));
+    return pool;
+}
+
+Scheduled Schedule(Priority priority) {
+    return {Get(), priority};
+}
+
 Scheduled Schedule() {
-    static Pool pool;
-    static std::thread thread([]() {
-        rtc::ThreadManager::Instance()->WrapCurrentThread();
-        pool.Run();
-    });
-    return {&pool};
+    return {Get(), Pool::current_};
+}
+
+void Resume(Stacked *stacked) noexcept {
+    Get()->Stack(stacked);
+}
+
+Delay Delayed(Priority priority) {
+    return Get()->Delayed(priority);
 }
 
 }
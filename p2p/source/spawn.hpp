@@ -32,9 +32,31 @@ namespace orc {
 
 class Pool;
 
+// Data (packet forwarding) is always run first; Control (signaling, tickets)
+// and Background (price and gas refreshes) are each only starved so long
+
+enum class Priority : uint8_t {
+    Data,
+    Control,
+    Background,
+};
+
+static const size_t Priorities(3);
+
+inline const char *Name(Priority priority) {
+    static const char *const names[Priorities] = {"data", "control", "background"};
+    return names[size_t(priority)];
+}
+
 struct Stacked {
     Stacked *next_ = nullptr;
     std::experimental::coroutine_handle<> code_;
+    Priority priority_ = Priority::Control;
+    uint64_t stamp_ = 0;
+    uint64_t flow_ = 0;
+#ifdef ORC_FIBER
+    Fiber::Handle fiber_;
+#endif
 };
 
 class Scheduled :
@@ -44,9 +66,13 @@ class Scheduled :
     Pool *pool_;
 
   public:
-    Scheduled(Pool *pool) :
+    Scheduled(Pool *pool, Priority priority) :
         pool_(pool)
     {
+        priority_ = priority;
+#ifdef ORC_FIBER
+        fiber_ = Fiber::Current();
+#endif
     }
 
     bool await_ready() noexcept {
@@ -59,8 +85,26 @@ class Scheduled :
     }
 };
 
+// the default is 1, and 0 means one worker per core; call this before Schedule()
+void Workers(unsigned count);
+
+Scheduled Schedule(Priority priority);
+// this inherits the priority of whatever the current worker is running
 Scheduled Schedule();
 
+// hands coroutines that another thread parked (chained through next_) back
+// to the pool all at once, waking as many workers as it needs
+void Resume(Stacked *stacked) noexcept;
+
+// time spent queued by each class, in nanoseconds, since the process began
+struct Delay {
+    uint64_t count_;
+    uint64_t total_;
+    uint64_t maximum_;
+};
+
+Delay Delayed(Priority priority);
+
 template <typename Type_>
 Type_ Wait(task<Type_> code, const char *name = nullptr) {
     // XXX: centralize Schedule?
@@ -77,6 +121,11 @@ class Detached {
   public:
     class promise_type {
       public:
+        static void *operator new(size_t size) {
+            return Frames::New(size); }
+        static void operator delete(void *data, size_t size) noexcept {
+            return Frames::Delete(data, size); }
+
         auto get_return_object() noexcept {
             return Detached();
         }
@@ -96,9 +145,9 @@ class Detached {
 };
 
 template <typename Code_>
-auto Spawn(Code_ code, const char *name) noexcept -> typename std::enable_if<noexcept(code())>::type {
-    [](Code_ code, const char *name) mutable noexcept -> Detached {
-        co_await Schedule();
+auto Spawn(Code_ code, const char *name, Priority priority = Priority::Control) noexcept -> typename std::enable_if<noexcept(code())>::type {
+    [](Code_ code, const char *name, Priority priority) mutable noexcept -> Detached {
+        co_await Schedule(priority);
 #ifdef ORC_FIBER
         auto task(code());
         Fiber fiber(name);
@@ -107,7 +156,7 @@ auto Spawn(Code_ code, const char *name) noexcept -> typename std::enable_if<noe
 #else
         co_await code();
 #endif
-    }(std::move(code), name);
+    }(std::move(code), name, priority);
 }
 
 }
@@ -24,9 +24,9 @@
 
 namespace orc {
 
-void Station::Land(Json::Value data) {
+void Station::Land(const Lazy &data) {
     orc_assert(data["jsonrpc"] == "2.0");
-    return Outer().Land(std::move(data));
+    return Outer().Land(data);
 }
 
 task<void> Station::Send(const std::string &method, const std::string &id, Argument args) {
@@ -24,25 +24,26 @@
 #define ORCHID_STATION_HPP
 
 #include "jsonrpc.hpp"
+#include "lazy.hpp"
 #include "link.hpp"
 
 namespace orc {
 
 class Station :
-    public Faucet<Drain<Json::Value>>,
-    public Drain<Json::Value>,
-    public Sunken<Pump<Json::Value, Json::Value>>
+    public Faucet<Drain<const Lazy &>>,
+    public Drain<const Lazy &>,
+    public Sunken<Pump<Json::Value, const Lazy &>>
 {
   protected:
-    void Land(Json::Value data) override;
+    void Land(const Lazy &data) override;
 
     void Stop(const std::string &error) noexcept override {
         return Faucet::Stop(error);
     }
 
   public:
-    Station(Drain<Json::Value> &drain) :
-        Faucet<Drain<Json::Value>>(drain)
+    Station(Drain<const Lazy &> &drain) :
+        Faucet<Drain<const Lazy &>>(drain)
     {
     }
 
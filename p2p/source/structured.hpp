@@ -24,18 +24,34 @@
 #define ORCHID_STRUCTURED_HPP
 
 #include "json.hpp"
+#include "lazy.hpp"
 #include "link.hpp"
 
 namespace orc {
 
 class Structured :
-    public Pump<Json::Value, Json::Value>,
+    public Pump<Json::Value, const Lazy &>,
     public BufferDrain,
     public Sunken<Pump<Buffer>>
 {
   protected:
     void Land(const Buffer &data) override {
-        return Pump::Land(Parse(data.str()));
+        // frames almost always arrive as one region, which is indexed in place
+        std::string_view text;
+        size_t count(0);
+        data.each([&](const uint8_t *begin, size_t size) {
+            text = {reinterpret_cast<const char *>(begin), size};
+            return ++count == 1;
+        });
+
+        if (count == 1) {
+            const Index index(text);
+            return Outer().Land(*index);
+        }
+
+        const auto flat(data.str());
+        const Index index(flat);
+        return Outer().Land(*index);
     }
 
     void Stop(const std::string &error) noexcept override {
@@ -43,8 +59,8 @@ class Structured :
     }
 
   public:
-    Structured(Drain<Json::Value> &drain) :
-        Pump<Json::Value, Json::Value>(drain)
+    Structured(Drain<const Lazy &> &drain) :
+        Pump<Json::Value, const Lazy &>(drain)
     {
         type_ = typeid(*this).name();
     }
@@ -20,46 +20,217 @@
 /* }}} */
 
 
-#include <set>
 
-#include "locked.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <vector>
+
 #include "task.hpp"
 
 namespace orc {
 
-Locked<std::set<Fiber *>> fibers_;
+// every thread keeps its own roster of fiber records, linked only ever at
+// the head and never unlinked, so a dump can walk them while fibers come
+// and go. finished records are handed back to the thread that made them
+
+class Roster;
+
+class Fiber::Record {
+  public:
+    Roster *const roster_;
+    Record *next_ = nullptr;
+    Record *free_ = nullptr;
+
+    // odd while the fiber is alive; bumped at its birth and at its death
+    std::atomic<uint64_t> generation_ = 0;
+
+    std::atomic<const char *> name_ = nullptr;
+    std::atomic<Record *> parent_ = nullptr;
+    std::atomic<uint64_t> birth_ = 0;
+    std::atomic<uint64_t> resumes_ = 0;
+    std::atomic<uint64_t> nanoseconds_ = 0;
+
+    Record(Roster *roster) :
+        roster_(roster)
+    {
+    }
+
+    bool Valid(uint64_t generation) const {
+        return generation_.load(std::memory_order_acquire) == generation;
+    }
+};
+
+static uint64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class Roster {
+  private:
+    static std::atomic<Roster *> rosters_;
+
+    Roster *next_ = nullptr;
+    std::atomic<Fiber::Record *> records_ = nullptr;
+
+    // free_ belongs to the owning thread; other threads push onto returned_
+    Fiber::Record *free_ = nullptr;
+    std::atomic<Fiber::Record *> returned_ = nullptr;
+
+  public:
+    static Roster *Get() {
+        // rosters are leaked with their records, as a dump might be walking them
+        static thread_local Roster *roster(nullptr);
+        if (roster == nullptr) {
+            roster = new Roster();
+            roster->next_ = rosters_.load();
+            while (!rosters_.compare_exchange_weak(roster->next_, roster));
+        }
+        return roster;
+    }
+
+    Fiber::Record *Take() {
+        if (free_ == nullptr)
+            free_ = returned_.exchange(nullptr, std::memory_order_acquire);
+        if (const auto record = free_) {
+            free_ = record->free_;
+            record->free_ = nullptr;
+            return record;
+        }
+
+        const auto record(new Fiber::Record(this));
+        record->next_ = records_.load(std::memory_order_relaxed);
+        records_.store(record, std::memory_order_release);
+        return record;
+    }
+
+    void Return(Fiber::Record *record) {
+        record->free_ = returned_.load(std::memory_order_relaxed);
+        while (!returned_.compare_exchange_weak(record->free_, record, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    template <typename Code_>
+    static void Each(Code_ &&code) {
+        for (auto roster(rosters_.load()); roster != nullptr; roster = roster->next_)
+            for (auto record(roster->records_.load(std::memory_order_acquire)); record != nullptr; record = record->next_)
+                code(*record);
+    }
+};
+
+std::atomic<Roster *> Roster::rosters_(nullptr);
+
+static thread_local Fiber::Handle current_;
 
 Fiber::Fiber(const char *name, Fiber *parent) :
-    name_(name),
-    parent_(parent)
+    parent_(parent),
+    record_(Roster::Get()->Take()),
+    previous_(current_)
 {
-    fibers_()->emplace(this);
+    record_->name_.store(name, std::memory_order_relaxed);
+    record_->parent_.store(parent == nullptr ? nullptr : parent->record_, std::memory_order_relaxed);
+    record_->birth_.store(Now(), std::memory_order_relaxed);
+    record_->resumes_.store(0, std::memory_order_relaxed);
+    record_->nanoseconds_.store(0, std::memory_order_relaxed);
+    const auto generation(record_->generation_.fetch_add(1, std::memory_order_release) + 1);
+
+    // fibers are made by the code that is about to run in them
+    current_ = {record_, generation};
 }
 
 Fiber::~Fiber() {
-    fibers_()->erase(this);
+    if (current_.record_ == record_)
+        current_ = previous_;
+    record_->generation_.fetch_add(1, std::memory_order_release);
+    record_->roster_->Return(record_);
 }
 
-void Fiber::Report() {
-    auto fibers(*fibers_());
-#if 0
-    for (const auto fiber : fibers)
-        if (const auto parent = fiber->parent_)
-            fibers.erase(parent);
-#endif
+void Fiber::Name(const char *name) {
+    record_->name_.store(name, std::memory_order_relaxed);
+}
+
+Fiber::Handle Fiber::Current() noexcept {
+    return current_;
+}
+
+uint64_t Fiber::Enter(const Handle &handle) noexcept {
+    if (handle.record_ != nullptr && handle.record_->Valid(handle.generation_))
+        handle.record_->resumes_.fetch_add(1, std::memory_order_relaxed);
+    current_ = handle;
+    return Now();
+}
+
+void Fiber::Leave(const Handle &handle, uint64_t start) noexcept {
+    // the fiber might have finished, or even been reborn, during the resume
+    if (handle.record_ != nullptr && handle.record_->Valid(handle.generation_))
+        handle.record_->nanoseconds_.fetch_add(Now() - start, std::memory_order_relaxed);
+    current_ = Handle();
+}
+
+namespace {
+struct Snapshot {
+    const Fiber::Record *record_;
+    const char *name_;
+    const Fiber::Record *parent_;
+    uint64_t birth_;
+    uint64_t resumes_;
+    uint64_t nanoseconds_;
+};
+}
+
+static std::vector<Snapshot> Snapshots() {
+    std::vector<Snapshot> snapshots;
+    Roster::Each([&](const Fiber::Record &record) {
+        const auto generation(record.generation_.load(std::memory_order_acquire));
+        if (generation % 2 == 0)
+            return;
+        Snapshot snapshot{&record, record.name_.load(std::memory_order_relaxed), record.parent_.load(std::memory_order_relaxed), record.birth_.load(std::memory_order_relaxed), record.resumes_.load(std::memory_order_relaxed), record.nanoseconds_.load(std::memory_order_relaxed)};
+        // if the record was recycled while we read it, the fields might be torn
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (record.Valid(generation))
+            snapshots.emplace_back(snapshot);
+    });
+    return snapshots;
+}
 
+static void Print(std::ostream &out, const Snapshot &snapshot, uint64_t now) {
+    out << snapshot.record_ << "/" << snapshot.parent_;
+    out << " " << std::fixed << std::setprecision(3) << snapshot.nanoseconds_ / 1e6 << "ms";
+    out << " " << std::dec << snapshot.resumes_ << "x";
+    out << " " << std::fixed << std::setprecision(1) << (now - snapshot.birth_) / 1e9 << "s";
+    if (snapshot.name_ != nullptr)
+        out << ": " << snapshot.name_;
+    out << std::endl;
+}
+
+void Fiber::Report() {
+    const auto now(Now());
     std::cerr << std::endl;
     std::cerr << "^^^^^^^^^^" << std::endl;
-    for (const auto fiber : fibers) {
-        std::cerr << fiber;
-        std::cerr << "/";
-        std::cerr << fiber->parent_;
-        if (fiber->name_ != nullptr)
-            std::cerr << ": " << fiber->name_;
-        std::cerr << std::endl;
-    }
+    for (const auto &snapshot : Snapshots())
+        Print(std::cerr, snapshot, now);
     std::cerr << "vvvvvvvvvv" << std::endl;
     std::cerr << std::endl;
 }
 
+void Fiber::Report(std::ostream &out, size_t top) {
+    const auto now(Now());
+    auto snapshots(Snapshots());
+    out << std::dec << snapshots.size() << " fibers" << std::endl;
+
+    const auto count(std::min(top, snapshots.size()));
+
+    std::partial_sort(snapshots.begin(), snapshots.begin() + count, snapshots.end(), [](const Snapshot &lhs, const Snapshot &rhs) {
+        return lhs.nanoseconds_ > rhs.nanoseconds_; });
+    out << std::endl << "by cpu:" << std::endl;
+    for (size_t i(0); i != count; ++i)
+        Print(out, snapshots[i], now);
+
+    std::partial_sort(snapshots.begin(), snapshots.begin() + count, snapshots.end(), [](const Snapshot &lhs, const Snapshot &rhs) {
+        return lhs.birth_ < rhs.birth_; });
+    out << std::endl << "by age:" << std::endl;
+    for (size_t i(0); i != count; ++i)
+        Print(out, snapshots[i], now);
+}
+
 }
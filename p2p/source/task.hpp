@@ -26,6 +26,7 @@
 #include <experimental/coroutine>
 
 #include "error.hpp"
+#include "frame.hpp"
 #include "maybe.hpp"
 
 namespace orc {
@@ -33,9 +34,21 @@ namespace orc {
 inline constexpr class {} orc_optic;
 
 class Fiber {
+  public:
+    class Record;
+
+    // this names a fiber without keeping it alive: records are recycled but
+    // never freed, and a stale generation makes every use of it a no-op
+    struct Handle {
+        Record *record_ = nullptr;
+        uint64_t generation_ = 0;
+    };
+
   private:
-    const char *name_;
     Fiber *parent_;
+    Record *const record_;
+    // whatever the thread was running when this fiber was made
+    const Handle previous_;
 
   public:
     Fiber(const char *name, Fiber *parent = nullptr);
@@ -44,12 +57,20 @@ class Fiber {
 
     ~Fiber();
 
-    void Name(const char *name) {
-        name_ = name; }
+    void Name(const char *name);
     Fiber *Parent() const {
         return parent_; }
 
+    // the fiber whose code the current thread is running, if known
+    static Handle Current() noexcept;
+
+    // the scheduler brackets each resume with these to count it and its CPU time
+    static uint64_t Enter(const Handle &handle) noexcept;
+    static void Leave(const Handle &handle, uint64_t start) noexcept;
+
     static void Report();
+    // the top fibers by CPU time and by age, for a live dump
+    static void Report(std::ostream &out, size_t top);
 };
 
 template <typename Type_>
@@ -170,6 +191,11 @@ class Promise {
 #endif
 
   public:
+    static void *operator new(size_t size) {
+        return Frames::New(size); }
+    static void operator delete(void *data, size_t size) noexcept {
+        return Frames::Delete(data, size); }
+
     auto initial_suspend() noexcept {
         return std::experimental::suspend_always(); }
     auto final_suspend() noexcept {
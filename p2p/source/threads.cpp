@@ -24,6 +24,50 @@
 
 namespace orc {
 
+Histogram posted_("post");
+
+void Batch::Push(Job *job) noexcept {
+    job->flow_ = Depart("post");
+    job->stamp_ = Bench::Now();
+    auto head(jobs_.load(std::memory_order_relaxed));
+    do job->next_ = head;
+    while (!jobs_.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+    // only whoever makes the stack non-empty posts, as the drain empties it all
+    if (head == nullptr)
+        thread_.Post(RTC_FROM_HERE, this);
+}
+
+void Batch::OnMessage(rtc::Message *message) {
+    Traced traced("batch");
+
+    // the stack is newest first, so reverse it to run jobs in order
+    Job *jobs(nullptr);
+    for (auto job(jobs_.exchange(nullptr, std::memory_order_acquire)); job != nullptr; ) {
+        const auto next(static_cast<Job *>(job->next_));
+        job->next_ = jobs;
+        jobs = job;
+        job = next;
+    }
+
+    const auto now(Bench::Now());
+    Stacked *done(nullptr), **tail(&done);
+    for (auto job(jobs); job != nullptr; ) {
+        // a job that stays parked may be linked into someone else's list
+        const auto next(static_cast<Job *>(job->next_));
+        job->next_ = nullptr;
+        posted_.Record(now - job->stamp_);
+        Arrive("post", job->flow_);
+        if (job->Run()) {
+            job->flow_ = Depart("schedule");
+            *tail = job;
+            tail = &job->next_;
+        }
+        job = next;
+    }
+
+    Resume(done);
+}
+
 const Threads &Threads::Get() {
     static Threads threads;
     return threads;
@@ -37,6 +81,8 @@ Threads::Threads() {
     working_ = rtc::Thread::Create();
     working_->SetName("Orchid WebRTC Workers", nullptr);
     working_->Start();
+
+    batch_ = std::make_unique<Batch>(*signals_);
 }
 
 }
@@ -25,10 +25,15 @@
 
 #include <rtc_base/thread.h>
 
+#include "bench.hpp"
 #include "event.hpp"
+#include "trace.hpp"
 
 namespace orc {
 
+// how long Post()ed code waits for its thread to pick it up
+extern Histogram posted_;
+
 template <typename Type_>
 class Result {
   private:
@@ -69,9 +74,14 @@ class Invoker :
     std::exception_ptr error_;
     Result<Type_> result_;
     Event ready_;
+    uint64_t flow_ = 0;
+    uint64_t start_ = 0;
 
   protected:
     void OnMessage(rtc::Message *message) override {
+        posted_.Record(Bench::Now() - start_);
+        Traced traced("post");
+        Arrive("post", flow_);
         try {
             result_.set(code_);
         } catch (const std::exception &exception) {
@@ -90,6 +100,8 @@ class Invoker :
     task<Result<Type_>> operator ()(rtc::Thread &thread) {
         // potentially pass value/ready as MessageData
         orc_assert(!ready_);
+        flow_ = Depart("post");
+        start_ = Bench::Now();
         thread.Post(RTC_FROM_HERE, this);
         co_await *ready_;
         if (error_)
@@ -98,11 +110,88 @@ class Invoker :
     }
 };
 
+class Job;
+
+// Batch collects Jobs for one thread in a lock-free stack, so a burst of
+// them costs a single rtc::Message, and hands back everything it finished
+// to the pool at once
+
+class Batch :
+    public rtc::MessageHandler
+{
+  private:
+    rtc::Thread &thread_;
+    std::atomic<Job *> jobs_ = nullptr;
+
+  protected:
+    void OnMessage(rtc::Message *message) override;
+
+  public:
+    Batch(rtc::Thread &thread) :
+        thread_(thread)
+    {
+    }
+
+    void Push(Job *job) noexcept;
+};
+
+// Job is work a coroutine parks on a Batch; once run, the coroutine goes back to the pool
+class Job :
+    public Stacked
+{
+  private:
+    Batch &batch_;
+
+  public:
+    Job(Batch &batch, Priority priority) :
+        batch_(batch)
+    {
+        priority_ = priority;
+    }
+
+    // false leaves the coroutine parked, for whoever kept the Job to Resume() later
+    virtual bool Run() noexcept = 0;
+
+    bool await_ready() noexcept {
+        return false;
+    }
+
+    void await_suspend(std::experimental::coroutine_handle<> code) noexcept {
+        code_ = code;
+        batch_.Push(this);
+    }
+
+    void await_resume() noexcept {
+    }
+};
+
+template <typename Code_>
+class Batched :
+    public Job
+{
+  private:
+    Code_ work_;
+
+  public:
+    Batched(Batch &batch, Code_ work, Priority priority) :
+        Job(batch, priority),
+        work_(std::move(work))
+    {
+    }
+
+    bool Run() noexcept override {
+        work_();
+        return true;
+    }
+};
+
 class Threads {
   public:
     std::unique_ptr<rtc::Thread> signals_;
     std::unique_ptr<rtc::Thread> working_;
 
+    std::unique_ptr<Batch> batch_;
+
     static const Threads &Get();
 
   private:
@@ -121,6 +210,13 @@ auto Post(Code_ code) noexcept(noexcept(code())) -> task<decltype(code())> {
     co_return co_await Post(std::move(code), *Threads::Get().signals_);
 }
 
+// like Post(), but for small noexcept work on the signaling thread, where
+// it runs along with anything else queued since the thread last woke up
+template <typename Code_>
+auto Signal(Code_ code, Priority priority = Priority::Data) noexcept -> typename std::enable_if<noexcept(code()), Batched<Code_>>::type {
+    return {*Threads::Get().batch_, std::move(code), priority};
+}
+
 }
 
 #endif//ORCHID_THREADS_HPP
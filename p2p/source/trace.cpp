@@ -0,0 +1,165 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <unistd.h>
+
+#include "trace.hpp"
+
+namespace orc {
+
+std::atomic<bool> tracing_(false);
+
+void Tracing(bool enabled) {
+    tracing_.store(enabled, std::memory_order_relaxed);
+}
+
+// each thread writes only to its own ring, overwriting its oldest events;
+// the fields are atomic so a dump can read them while the thread runs on
+
+class Ring {
+  public:
+    static const size_t Size = 1 << 16;
+
+  private:
+    struct Entry {
+        std::atomic<const char *> name_;
+        std::atomic<uint64_t> time_;
+        std::atomic<uint64_t> flow_;
+        std::atomic<char> phase_;
+    };
+
+    static std::atomic<Ring *> rings_;
+    static std::atomic<unsigned> threads_;
+
+    Ring *next_ = nullptr;
+    const unsigned thread_;
+    std::atomic<uint64_t> head_ = 0;
+    Entry entries_[Size];
+
+    Ring() :
+        thread_(++threads_)
+    {
+    }
+
+  public:
+    static Ring *Get() {
+        // rings are leaked, as a dump might be reading one after its thread exits
+        static thread_local Ring *ring(nullptr);
+        if (ring == nullptr) {
+            ring = new Ring();
+            ring->next_ = rings_.load();
+            while (!rings_.compare_exchange_weak(ring->next_, ring));
+        }
+        return ring;
+    }
+
+    void Push(Phase phase, const char *name, uint64_t flow) noexcept {
+        const auto head(head_.load(std::memory_order_relaxed));
+        auto &entry(entries_[head % Size]);
+        entry.name_.store(name, std::memory_order_relaxed);
+        entry.time_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+        entry.flow_.store(flow, std::memory_order_relaxed);
+        entry.phase_.store(char(phase), std::memory_order_relaxed);
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    template <typename Code_>
+    static void Each(Code_ &&code) {
+        for (auto ring(rings_.load()); ring != nullptr; ring = ring->next_)
+            code(*ring);
+    }
+
+    void Dump(std::ostream &out, bool &comma) const {
+        struct Copy {
+            const char *name_;
+            uint64_t time_;
+            uint64_t flow_;
+            char phase_;
+        };
+
+        const auto head(head_.load(std::memory_order_acquire));
+        const auto begin(head > Size ? head - Size : 0);
+
+        std::vector<Copy> copies;
+        copies.reserve(head - begin);
+        for (auto i(begin); i != head; ++i) {
+            const auto &entry(entries_[i % Size]);
+            copies.push_back({entry.name_.load(std::memory_order_relaxed), entry.time_.load(std::memory_order_relaxed), entry.flow_.load(std::memory_order_relaxed), entry.phase_.load(std::memory_order_relaxed)});
+        }
+
+        // anything the thread lapped while we were copying might be torn
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const auto after(head_.load(std::memory_order_relaxed));
+        const auto valid(after > Size ? after - Size : 0);
+
+        for (auto i(std::max(begin, valid)); i < head; ++i) {
+            const auto &copy(copies[i - begin]);
+            out << (comma ? ",\n" : "\n");
+            comma = true;
+            out << "{\"name\":\"" << copy.name_ << "\",\"cat\":\"orchid\",\"ph\":\"" << copy.phase_ << "\"";
+            out << ",\"ts\":" << std::fixed << std::setprecision(3) << copy.time_ / 1000.0;
+            out << ",\"pid\":" << std::dec << getpid() << ",\"tid\":" << thread_;
+            if (copy.phase_ == char(Phase::Start) || copy.phase_ == char(Phase::Finish))
+                out << ",\"id\":" << copy.flow_;
+            if (copy.phase_ == char(Phase::Finish))
+                out << ",\"bp\":\"e\"";
+            if (copy.phase_ == char(Phase::Instant))
+                out << ",\"s\":\"t\"";
+            out << "}";
+        }
+    }
+};
+
+std::atomic<Ring *> Ring::rings_(nullptr);
+std::atomic<unsigned> Ring::threads_(0);
+
+void Trace(Phase phase, const char *name, uint64_t flow) noexcept {
+    Ring::Get()->Push(phase, name, flow);
+}
+
+uint64_t Depart(const char *name) noexcept {
+    if (!Tracing())
+        return 0;
+    static std::atomic<uint64_t> flows_(0);
+    const auto flow(++flows_);
+    Trace(Phase::Start, name, flow);
+    return flow;
+}
+
+void Trace(std::ostream &out) {
+    out << "{\"traceEvents\":[";
+    bool comma(false);
+    Ring::Each([&](const Ring &ring) {
+        ring.Dump(out, comma);
+    });
+    out << "\n]}" << std::endl;
+}
+
+}
@@ -0,0 +1,90 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+
+
+#ifndef ORCHID_TRACE_HPP
+#define ORCHID_TRACE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+
+namespace orc {
+
+// tracing records into per-thread rings that are dumped as Chrome trace JSON
+// (chrome://tracing or ui.perfetto.dev); while it is off, every hook below
+// is a single relaxed load and a branch
+
+extern std::atomic<bool> tracing_;
+
+inline bool Tracing() {
+    return tracing_.load(std::memory_order_relaxed);
+}
+
+void Tracing(bool enabled);
+
+enum class Phase : char {
+    Begin = 'B',
+    End = 'E',
+    Instant = 'i',
+    Start = 's',
+    Finish = 'f',
+};
+
+void Trace(Phase phase, const char *name, uint64_t flow = 0) noexcept;
+
+// Traced covers synchronous code on one thread; never hold one across a co_await
+class Traced {
+  private:
+    const char *const name_;
+
+  public:
+    Traced(const char *name) noexcept :
+        name_(Tracing() ? name : nullptr)
+    {
+        if (name_ != nullptr)
+            Trace(Phase::Begin, name_);
+    }
+
+    Traced(const Traced &traced) = delete;
+
+    ~Traced() {
+        if (name_ != nullptr)
+            Trace(Phase::End, name_);
+    }
+};
+
+// a flow links where work is handed off (Schedule, Post, an asio operation)
+// to wherever it picks back up; 0 means tracing was off when it departed
+uint64_t Depart(const char *name) noexcept;
+
+inline void Arrive(const char *name, uint64_t flow) noexcept {
+    if (flow != 0)
+        Trace(Phase::Finish, name, flow);
+}
+
+void Trace(std::ostream &out);
+
+}
+
+#endif//ORCHID_TRACE_HPP
@@ -61,7 +61,7 @@ class Updater :
             }
 
             Stop();
-        }, name);
+        }, name, Priority::Background);
     }
 
     Task<void> Open() override {
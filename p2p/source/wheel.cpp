@@ -0,0 +1,204 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "wheel.hpp"
+
+namespace orc {
+
+// a single thread drives every timer in the process; deadlines are rounded up
+// to a 10ms tick, so thousands of tunnels that tick every 100ms share wakeups
+
+// each level has 256 slots, and each slot of a level spans a full revolution
+// of the level below it; timers cascade down a level as their slot comes due
+
+static const std::chrono::milliseconds Tick(10);
+static const unsigned Bits(8);
+static const unsigned Slots(1 << Bits);
+static const unsigned Levels(4);
+
+class Wheel {
+  private:
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::condition_variable fired_;
+
+    const std::chrono::steady_clock::time_point epoch_;
+    uint64_t now_ = 0;
+    size_t count_ = 0;
+
+    Timer slots_[Levels][Slots];
+
+    std::thread::id thread_;
+    Timer *firing_ = nullptr;
+
+    static void Unlink(Timer *timer) {
+        timer->prev_->next_ = timer->next_;
+        timer->next_->prev_ = timer->prev_;
+        timer->prev_ = nullptr;
+        timer->next_ = nullptr;
+    }
+
+    void Link(Timer *timer) {
+        const auto delta(timer->when_ - now_);
+
+        unsigned level(0);
+        while (level != Levels - 1 && delta >= uint64_t(1) << Bits * (level + 1))
+            ++level;
+
+        // anything past the top level is parked in its last slot and cascaded again
+        const auto when(level == Levels - 1 && delta >= uint64_t(1) << Bits * Levels ? now_ + (uint64_t(1) << Bits * Levels) - 1 : timer->when_);
+
+        auto &slot(slots_[level][when >> Bits * level & Slots - 1]);
+        timer->prev_ = slot.prev_;
+        timer->next_ = &slot;
+        slot.prev_->next_ = timer;
+        slot.prev_ = timer;
+    }
+
+    void Cascade(unsigned level) {
+        auto &slot(slots_[level][now_ >> Bits * level & Slots - 1]);
+        while (slot.next_ != &slot) {
+            const auto timer(slot.next_);
+            Unlink(timer);
+            Link(timer);
+        }
+    }
+
+    uint64_t Elapsed() const {
+        return (std::chrono::steady_clock::now() - epoch_) / Tick;
+    }
+
+    void Run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            const auto elapsed(Elapsed());
+
+            if (count_ == 0) {
+                // the wheel is empty, so there is nothing to cascade
+                now_ = elapsed;
+                ready_.wait(lock);
+                continue;
+            }
+
+            if (now_ == elapsed) {
+                ready_.wait_until(lock, epoch_ + Tick * (now_ + 1));
+                continue;
+            }
+
+            ++now_;
+            for (unsigned level(1); level != Levels && (now_ & (uint64_t(1) << Bits * level) - 1) == 0; ++level)
+                Cascade(level);
+
+            auto &slot(slots_[0][now_ & Slots - 1]);
+            while (slot.next_ != &slot) {
+                const auto timer(slot.next_);
+                Unlink(timer);
+                --count_;
+
+                firing_ = timer;
+                lock.unlock();
+                timer->code_();
+                lock.lock();
+                firing_ = nullptr;
+                fired_.notify_all();
+            }
+        }
+    }
+
+  public:
+    Wheel() :
+        epoch_(std::chrono::steady_clock::now())
+    {
+        for (auto &level : slots_)
+            for (auto &slot : level)
+                slot.prev_ = slot.next_ = &slot;
+
+        std::thread thread([this]() { Run(); });
+        thread_ = thread.get_id();
+        thread.detach();
+    }
+
+    static Wheel *Get() {
+        // this is leaked, as its thread is waiting on it until the process exits
+        static const auto wheel(new Wheel());
+        return wheel;
+    }
+
+    void Set(Timer *timer, unsigned milliseconds) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (timer->next_ != nullptr) {
+            Unlink(timer);
+            --count_;
+        } else if (count_ == 0)
+            // the driver stops counting ticks while it has nothing to do
+            now_ = Elapsed();
+
+        // now_ may lag behind the clock, so the deadline is rounded up from the clock itself
+        const auto when((std::chrono::steady_clock::now() - epoch_ + std::chrono::milliseconds(milliseconds) + Tick - std::chrono::nanoseconds(1)) / Tick);
+        timer->when_ = std::max<uint64_t>(when, now_ + 1);
+        Link(timer);
+
+        if (count_++ == 0)
+            ready_.notify_one();
+    }
+
+    bool Cancel(Timer *timer) {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        // let a running callback finish first, as it might rearm the timer
+        if (std::this_thread::get_id() != thread_)
+            while (firing_ == timer)
+                fired_.wait(lock);
+
+        if (timer->next_ == nullptr)
+            return false;
+        Unlink(timer);
+        --count_;
+        return true;
+    }
+};
+
+Timer::Timer(std::function<void ()> code) :
+    code_(std::move(code))
+{
+}
+
+Timer::~Timer() {
+    if (code_ != nullptr)
+        Wheel::Get()->Cancel(this);
+}
+
+void Timer::Set(unsigned milliseconds) {
+    Wheel::Get()->Set(this, milliseconds);
+}
+
+bool Timer::Cancel() {
+    return Wheel::Get()->Cancel(this);
+}
+
+}
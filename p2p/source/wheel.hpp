@@ -0,0 +1,109 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#ifndef ORCHID_WHEEL_HPP
+#define ORCHID_WHEEL_HPP
+
+#include <cstdint>
+#include <functional>
+
+#include <experimental/coroutine>
+
+namespace orc {
+
+class Wheel;
+
+// Timer is a cancellation handle for a callback on the shared timing wheel;
+// destroying it cancels it, waiting out the callback if it is running now
+
+class Timer {
+    friend class Wheel;
+
+  private:
+    Timer *prev_ = nullptr;
+    Timer *next_ = nullptr;
+    uint64_t when_ = 0;
+
+    std::function<void ()> code_;
+
+    // only the wheel's list heads are built this way
+    Timer() = default;
+
+  public:
+    Timer(std::function<void ()> code);
+
+    Timer(const Timer &timer) = delete;
+    Timer(Timer &&timer) = delete;
+
+    ~Timer();
+
+    // (re)arms the timer, replacing whatever time it had been set for
+    void Set(unsigned milliseconds);
+    // returns false if the timer was not armed (or has already fired)
+    bool Cancel();
+};
+
+// Alarm suspends a coroutine on the wheel; Sleep() is built on top of this
+class Alarm {
+  private:
+    Timer timer_;
+    std::experimental::coroutine_handle<> code_;
+    const unsigned milliseconds_;
+
+    class Awaiter {
+      private:
+        Alarm &alarm_;
+
+      public:
+        Awaiter(Alarm &alarm) :
+            alarm_(alarm)
+        {
+        }
+
+        bool await_ready() noexcept {
+            return false;
+        }
+
+        void await_suspend(std::experimental::coroutine_handle<> code) noexcept {
+            alarm_.code_ = code;
+            alarm_.timer_.Set(alarm_.milliseconds_);
+        }
+
+        void await_resume() noexcept {
+        }
+    };
+
+  public:
+    Alarm(unsigned milliseconds) :
+        timer_([this]() { code_.resume(); }),
+        milliseconds_(milliseconds)
+    {
+    }
+
+    Awaiter operator co_await() noexcept {
+        return *this;
+    }
+};
+
+}
+
+#endif//ORCHID_WHEEL_HPP
@@ -40,20 +40,18 @@ static const auto Bound_(Hash("Update(address,address)"));
 
 task<void> Cashier::Look(const Address &signer, const Address &funder, const std::string &combined) {
     static const auto look(Hash("look(address,address)").Clip<4>().num<uint32_t>());
-    Builder builder;
-    Coder<Address, Address>::Encode(builder, funder, signer);
+    const auto arguments(Coder<Address, Address>::Pack(funder, signer));
     co_await station_->Send("eth_call", 'C' + combined, {Multi{
         {"to", lottery_},
         {"gas", uint256_t(90000)},
-        {"data", Tie(look, builder)},
+        {"data", Tie(look, arguments)},
     }, "latest"});
 }
 
-void Cashier::Land(Json::Value data) {
+void Cashier::Land(const Lazy &data) {
     const auto id(data["id"]);
     if (id.isNull()) {
-        const auto method(data["method"].asString());
-        orc_assert(method == "eth_subscription");
+        orc_assert(data["method"] == "eth_subscription");
 
         const auto params(data["params"]);
         const auto result(params["result"]);
@@ -86,7 +84,7 @@ void Cashier::Land(Json::Value data) {
             }());
 #endif
 
-            const auto data(Bless(result["data"].asString()));
+            const auto data(Bless(result["data"].raw()));
             Window window(data);
             const auto [amount, escrow, unlock] = Coded<std::tuple<uint128_t, uint128_t, uint256_t>>::Decode(window);
             window.Stop();
@@ -103,18 +101,18 @@ void Cashier::Land(Json::Value data) {
             std::cout << "BIND " << data << std::endl;
         } else orc_throw("unknown message " << data);
     } else {
-        const auto value(id.asString());
+        const auto value(id.raw());
         const auto [identity] = Take<Identity>(Bless(value.substr(1)));
-        const auto result(data["result"].asString());
+        const auto result(data["result"]);
         switch (value[0]) {
             case 'S': {
-                orc_assert(cache_()->subscriptions_.emplace(result, identity).second);
+                orc_assert(cache_()->subscriptions_.emplace(result.asString(), identity).second);
             } break;
 
             case 'C': {
-                const auto data(Bless(result));
+                const auto data(Bless(result.raw()));
                 Window window(data);
-                const auto [amount, escrow, unlock, verify, codehash, shared] = Coded<std::tuple<uint128_t, uint128_t, uint256_t, Address, Bytes32, Bytes>>::Decode(window);
+                const auto [amount, escrow, unlock, verify, codehash, shared] = Coded<std::tuple<uint128_t, uint128_t, uint256_t, Address, Bytes32, Range>>::Decode(window);
                 window.Stop();
 
                 const auto pot([this, &identity = identity]() {
@@ -167,7 +165,7 @@ void Cashier::Open(S<Origin> origin, Locator locator) {
         auto duplex(std::make_unique<Duplex>(origin));
         co_await duplex->Open(locator);
 
-        auto station(std::make_unique<Covered<Sink<Station, Drain<Json::Value>>>>(*this));
+        auto station(std::make_unique<Covered<Sink<Station, Drain<const Lazy &>>>>(*this));
         auto &structured(station->Wire<BufferSink<Structured>>());
         auto &inverted(structured.Wire<Inverted>(std::move(duplex)));
         inverted.Open();
@@ -59,7 +59,7 @@ struct Pot :
 
 class Cashier :
     public Valve,
-    public Drain<Json::Value>
+    public Drain<const Lazy &>
 {
   private:
     const Endpoint endpoint_;
@@ -85,7 +85,7 @@ class Cashier :
     task<void> Look(const Address &signer, const Address &funder, const std::string &combined);
 
   protected:
-    void Land(Json::Value data) override;
+    void Land(const Lazy &data) override;
     void Stop(const std::string &error) noexcept override;
 
   public:
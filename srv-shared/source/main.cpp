@@ -41,10 +41,14 @@
 #include <rtc_base/ssl_fingerprint.h>
 
 #include "baton.hpp"
+#include "bench.hpp"
+#include "bond.hpp"
 #include "boring.hpp"
 #include "cashier.hpp"
 #include "channel.hpp"
+#include "coalesce.hpp"
 #include "coinbase.hpp"
+#include "compress.hpp"
 #include "egress.hpp"
 #include "jsonrpc.hpp"
 #include "load.hpp"
@@ -53,8 +57,10 @@
 #include "router.hpp"
 #include "scope.hpp"
 #include "server.hpp"
+#include "spawn.hpp"
 #include "store.hpp"
 #include "task.hpp"
+#include "trace.hpp"
 #include "transport.hpp"
 #include "utility.hpp"
 
@@ -112,6 +118,30 @@ int Main(int argc, const char *const argv[]) {
         ("price", po::value<std::string>()->default_value("0.03"), "price of bandwidth in currency / GB")
     ; options.add(group); }
 
+    { po::options_description group("task scheduling");
+    group.add_options()
+        ("workers", po::value<unsigned>()->default_value(0), "number of scheduler threads (0 for one per core)")
+        ("trace", "record trace events, served as Chrome trace JSON from /trace")
+        ("diagnostics", po::value<uint16_t>()->default_value(0), "port on 127.0.0.1 serving /metrics, /fibers and /trace (0 for none)")
+    ; options.add(group); }
+
+    { po::options_description group("data channel flow control");
+    group.add_options()
+        ("send-queue", po::value<size_t>()->default_value(Flow().limit_), "packets queued per channel before senders wait")
+        ("send-watermark", po::value<size_t>()->default_value(Flow().watermark_), "queued packets past which the drop policy applies")
+        ("send-drop", po::value<std::string>()->default_value("codel"), "drop policy past the watermark: none, tail, head or codel")
+        ("bypass", po::value<bool>()->default_value(true), "let clients that ask for it skip SCTP, sending raw DTLS datagrams")
+        ("coalesce-bytes", po::value<size_t>()->default_value(Coalescing().size_), "pack smaller packets into messages this big, for clients that ask (0 to refuse)")
+        ("coalesce-delay", po::value<unsigned>()->default_value(Coalescing().delay_), "microseconds a packed message waits to fill up")
+        ("compress", po::value<int>()->default_value(Compression().acceleration_), "LZ4 acceleration for clients that ask to compress messages (0 to refuse, higher is faster)")
+        ("compress-bill", po::value<std::string>()->default_value("packet"), "bill compressed sessions by packet or by wire bytes")
+    ; options.add(group); }
+
+    { po::options_description group("channel bonding");
+    group.add_options()
+        ("stripe", po::value<std::string>()->default_value("flow"), "spreading of packets over a client's channels: first, weighted or flow")
+    ; options.add(group); }
+
     { po::options_description group("packet egress");
     group.add_options()
         ("openvpn", po::value<std::string>(), "OpenVPN .ovpn configuration file")
@@ -144,7 +174,57 @@ int Main(int argc, const char *const argv[]) {
     }
 
 
+    Workers(args["workers"].as<unsigned>());
+    if (args.count("trace") != 0)
+        Tracing(true);
+
+    Flows([&]() {
+        Flow flow;
+        flow.limit_ = args["send-queue"].as<size_t>();
+        flow.watermark_ = args["send-watermark"].as<size_t>();
+        const auto drop(args["send-drop"].as<std::string>());
+        if (drop == "none")
+            flow.drop_ = Drop::None;
+        else if (drop == "tail")
+            flow.drop_ = Drop::Tail;
+        else if (drop == "head")
+            flow.drop_ = Drop::Head;
+        else if (drop == "codel")
+            flow.drop_ = Drop::Delay;
+        else orc_assert_(false, "unknown --send-drop " << drop);
+        return flow;
+    }());
+    Bypasses(args["bypass"].as<bool>());
+    Coalescings([&]() {
+        Coalescing coalescing;
+        coalescing.size_ = args["coalesce-bytes"].as<size_t>();
+        coalescing.delay_ = args["coalesce-delay"].as<unsigned>();
+        return coalescing;
+    }());
+    Compressions([&]() {
+        Compression compression;
+        compression.acceleration_ = args["compress"].as<int>();
+        const auto bill(args["compress-bill"].as<std::string>());
+        if (bill == "wire")
+            compression.wire_ = true;
+        else orc_assert_(bill == "packet", "unknown --compress-bill " << bill);
+        return compression;
+    }());
+
+    Stripes([&]() {
+        Striping striping;
+        const auto stripe(args["stripe"].as<std::string>());
+        if (stripe == "first")
+            striping.stripe_ = Stripe::First;
+        else if (stripe == "weighted")
+            striping.stripe_ = Stripe::Weighted;
+        else if (stripe == "flow")
+            striping.stripe_ = Stripe::Flow;
+        else orc_assert_(false, "unknown --stripe " << stripe);
+        return striping;
+    }());
     Initialize();
+    Summarize(60000);
 
     std::vector<std::string> ice;
     ice.emplace_back("stun:" + args["stun"].as<std::string>());
@@ -301,7 +381,7 @@ int Main(int argc, const char *const argv[]) {
     }());
 
     const auto node(Make<Node>(std::move(origin), std::move(cashier), std::move(egress), std::move(ice)));
-    node->Run(path, asio::ip::make_address(args["bind"].as<std::string>()), port, store.Key(), store.Chain(), params);
+    node->Run(path, asio::ip::make_address(args["bind"].as<std::string>()), port, args["diagnostics"].as<uint16_t>(), store.Key(), store.Chain(), params);
     return 0;
 }
 
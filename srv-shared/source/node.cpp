@@ -20,13 +20,18 @@
 /* }}} */
 
 
+#include <sstream>
+
 #include "baton.hpp"
+#include "bench.hpp"
 #include "node.hpp"
 #include "router.hpp"
+#include "spawn.hpp"
+#include "trace.hpp"
 
 namespace orc {
 
-void Node::Run(const std::string &path, const asio::ip::address &bind, uint16_t port, const std::string &key, const std::string &chain, const std::string &params) {
+void Node::Run(const std::string &path, const asio::ip::address &bind, uint16_t port, uint16_t diagnostics, const std::string &key, const std::string &chain, const std::string &params) {
     Router router;
 
     router(http::verb::post, path, [&](Request request) -> task<Response> {
@@ -42,18 +47,50 @@ void Node::Run(const std::string &path, const asio::ip::address &bind, uint16_t
         const auto server(Find(fingerprint));
         auto answer(co_await server->Respond(offer, ice_));
 
-        Log() << std::endl;
-        Log() << "^^^^^^^^^^^^^^^^" << std::endl;
-        Log() << offer << std::endl;
-        Log() << "================" << std::endl;
-        Log() << answer << std::endl;
-        Log() << "vvvvvvvvvvvvvvvv" << std::endl;
-        Log() << std::endl;
+        orc_Level(Debug) << std::endl
+            << "^^^^^^^^^^^^^^^^" << std::endl
+            << offer << std::endl
+            << "================" << std::endl
+            << answer << std::endl
+            << "vvvvvvvvvvvvvvvv" << std::endl
+            << std::endl;
 
         co_return Respond(request, http::status::ok, "text/plain", std::move(answer));
     });
 
+    // these are cheap to ask for and expensive (and revealing) to answer, so
+    // they are kept off the public endpoint, on one that is only on loopback
+    Router admin;
+
+    admin(http::verb::get, "/metrics", [&](Request request) -> task<Response> {
+        std::ostringstream body;
+        for (size_t priority(0); priority != Priorities; ++priority) {
+            const auto delay(Delayed(Priority(priority)));
+            const auto name(Name(Priority(priority)));
+            body << "orchid_queue_delay_seconds_count{class=\"" << name << "\"} " << delay.count_ << "\n";
+            body << "orchid_queue_delay_seconds_sum{class=\"" << name << "\"} " << delay.total_ / 1e9 << "\n";
+            body << "orchid_queue_delay_seconds_max{class=\"" << name << "\"} " << delay.maximum_ / 1e9 << "\n";
+        }
+        Metrics(body);
+        co_return Respond(request, http::status::ok, "text/plain", body.str());
+    });
+
+    // fibers are only tracked in builds with ORC_FIBER; otherwise this is empty
+    admin(http::verb::get, "/fibers", [&](Request request) -> task<Response> {
+        std::ostringstream body;
+        Fiber::Report(body, 20);
+        co_return Respond(request, http::status::ok, "text/plain", body.str());
+    });
+
+    admin(http::verb::get, "/trace", [&](Request request) -> task<Response> {
+        std::ostringstream body;
+        Trace(body);
+        co_return Respond(request, http::status::ok, "application/json", body.str());
+    });
+
     router.Run(bind, port, key, chain, params);
+    if (diagnostics != 0)
+        admin.Run(asio::ip::address_v4::loopback(), diagnostics, key, chain, params);
     Thread().join();
 }
 
@@ -65,7 +65,8 @@ class Node final {
         return server;
     }
 
-    void Run(const std::string &path, const asio::ip::address &bind, uint16_t port, const std::string &key, const std::string &chain, const std::string &params);
+    // diagnostics (0 for none) is a port on 127.0.0.1 for /metrics, /fibers and /trace
+    void Run(const std::string &path, const asio::ip::address &bind, uint16_t port, uint16_t diagnostics, const std::string &key, const std::string &chain, const std::string &params);
 };
 
 }
@@ -23,8 +23,11 @@
 #include <api/jsep_session_description.h>
 #include <pc/webrtc_sdp.h>
 
+#include "bench.hpp"
 #include "cashier.hpp"
 #include "channel.hpp"
+#include "coalesce.hpp"
+#include "compress.hpp"
 #include "crypto.hpp"
 #include "datagram.hpp"
 #include "endpoint.hpp"
@@ -35,21 +38,56 @@
 
 namespace orc {
 
+// from a packet landing to it being sent on, and from a ticket to its check
+static Histogram forward_("forward");
+static Histogram ticket_("ticket");
+
 class Incoming final :
     public Peer
 {
   private:
     S<Incoming> self_;
   private:
-    S<Server> server_;
+    // a client can open several channels, each bonded to the server; held
+    // strongly, this would keep the server alive as long as its channels
+    const W<Server> server_;
+    // the answer agreed to bypass SCTP; the first channel will (see Raw)
+    std::atomic<bool> bypass_;
+    // the answer agreed to coalesce, so every channel gets a Coalesce
+    const bool coalesce_;
+    // ...and likewise a Compress, which refunds what it saves if wire_
+    const bool compress_;
+    const bool wire_;
 
   protected:
     void Land(rtc::scoped_refptr<webrtc::DataChannelInterface> interface) override {
-        auto &bonding(server_->Bond());
-        auto &channel(bonding.Wire<Channel>(shared_from_this(), interface));
+        auto server(server_.lock());
+        if (server == nullptr) {
+            interface->Close();
+            return;
+        }
+
+        auto &bonding(server->Bond());
+        BufferSunk *sunk(&bonding);
+        if (coalesce_) {
+            auto &coalesce(sunk->Wire<BufferSink<Coalesce>>());
+            coalesce.Engage();
+            sunk = &coalesce;
+        }
+        if (compress_) {
+            auto &compress(sunk->Wire<BufferSink<Compress>>());
+            // the bonding, and so this, doesn't outlive the server
+            compress.Engage(wire_ ? Compress::Refund([server = server.get()](size_t size) {
+                server->Refund(size);
+            }) : nullptr);
+            sunk = &compress;
+        }
+        auto &channel(sunk->Wire<Channel>(shared_from_this(), interface));
 
-        Spawn([&bonding, &channel, server = std::move(server_)]() noexcept -> task<void> {
+        Spawn([&bonding, &channel, server = std::move(server), bypass = bypass_.exchange(false)]() noexcept -> task<void> {
             co_await channel.Open();
+            if (bypass)
+                co_await channel.Raw();
             // XXX: this could fail; then what?
             co_await server->Open(bonding);
         }, __FUNCTION__);
@@ -60,14 +98,18 @@ class Incoming final :
     }
 
   public:
-    Incoming(S<Server> server, const S<Origin> &origin, rtc::scoped_refptr<rtc::RTCCertificate> local, std::vector<std::string> ice) :
+    Incoming(S<Server> server, const S<Origin> &origin, rtc::scoped_refptr<rtc::RTCCertificate> local, std::vector<std::string> ice, bool bypass, bool coalesce, bool compress, bool wire) :
         Peer(origin, [&]() {
             Configuration configuration;
             configuration.tls_ = std::move(local);
             configuration.ice_ = std::move(ice);
             return configuration;
         }()),
-        server_(std::move(server))
+        server_(std::move(server)),
+        bypass_(bypass),
+        coalesce_(coalesce),
+        compress_(compress),
+        wire_(wire)
     {
     }
 
@@ -106,14 +148,23 @@ bool Server::Bill(const Buffer &data, bool force) {
     return false;
 }
 
+void Server::Refund(size_t size) {
+    if (cashier_ == nullptr)
+        return;
+    const auto amount(cashier_->Bill(size));
+    const auto locked(locked_());
+    locked->balance_ += amount;
+}
+
 task<void> Server::Send(Pipe &pipe, const Buffer &data, bool force) {
     if (Bill(data, force))
         co_return co_await pipe.Send(data);
 }
 
 void Server::Send(Pipe &pipe, const Buffer &data) {
-    nest_.Hatch([&]() noexcept { return [this, &pipe, data = Beam(data)]() -> task<void> {
-        co_return co_await Send(pipe, data, false); }; }, __FUNCTION__);
+    nest_.Hatch([&]() noexcept { return [this, &pipe, data = Beam(data), start = Bench::Now()]() -> task<void> {
+        Bench bench(forward_, start);
+        co_return co_await Send(pipe, data, false); }; }, __FUNCTION__, Priority::Data);
 }
 
 task<void> Server::Send(const Buffer &data) {
@@ -149,6 +200,8 @@ task<void> Server::Invoice(Pipe<Buffer> &pipe, const Socket &destination, const
 }
 
 void Server::Submit(Pipe<Buffer> *pipe, const Socket &source, const Bytes32 &id, const Buffer &data) {
+    const auto submitted(Bench::Now());
+
     const auto [
         v, r, s,
         commit,
@@ -222,8 +275,9 @@ void Server::Submit(Pipe<Buffer> *pipe, const Socket &source, const Bytes32 &id,
 
     // XXX: the C++ prohibition on automatic capture of a binding name because it isn't a "variable" is ridiculous
     // NOLINTNEXTLINE (clang-analyzer-optin.performance.Padding)
-    Spawn([=, price = price, commit = commit, issued = issued, nonce = nonce, v = v, r = r, s = s, amount = amount, ratio = ratio, start = start, range = range, funder = funder, recipient = recipient, reveal = reveal, winner = winner]() noexcept -> task<void> { try {
+    Spawn([=, price = price, commit = commit, issued = issued, nonce = nonce, v = v, r = r, s = s, amount = amount, ratio = ratio, start = start, range = range, funder = funder, recipient = recipient, reveal = reveal, winner = winner, submitted = submitted]() noexcept -> task<void> { try {
         const auto valid(co_await cashier_->Check(signer, funder, amount, recipient, receipt));
+        ticket_.Record(Bench::Now() - submitted);
 
         {
             const auto locked(locked_());
@@ -328,8 +382,22 @@ task<void> Server::Shut() noexcept {
 }
 
 task<std::string> Server::Respond(const std::string &offer, std::vector<std::string> ice) {
-    auto incoming(Incoming::Create(self_, origin_, local_, std::move(ice)));
+    const auto bypass(Bypasses() && Proposed(offer, "bypass"));
+    const auto coalesce(Coalescings().size_ != 0 && Proposed(offer, "coalesce"));
+    const auto compression(Compressions());
+    const auto compress(compression.acceleration_ != 0 && Proposed(offer, "compress"));
+    const auto wire(compress && compression.wire_);
+    auto incoming(Incoming::Create(self_, origin_, local_, std::move(ice), bypass, coalesce, compress, wire));
     auto answer(co_await incoming->Answer(offer));
+    if (bypass)
+        answer = Propose(std::move(answer), "bypass");
+    if (coalesce)
+        answer = Propose(std::move(answer), "coalesce");
+    if (compress)
+        answer = Propose(std::move(answer), "compress");
+    // the client bills itself the same way, so it knows when to pay
+    if (wire)
+        answer = Propose(std::move(answer), "compress-wire");
     co_return answer;
     co_return Filter(true, answer);
 }
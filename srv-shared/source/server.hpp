@@ -100,6 +100,9 @@ class Server :
     task<void> Open(Pipe<Buffer> &pipe);
     task<void> Shut() noexcept override;
 
+    // when billing by the wire, a Compress gives back what it saved
+    void Refund(size_t size);
+
     task<std::string> Respond(const std::string &offer, std::vector<std::string> ice);
 };
 
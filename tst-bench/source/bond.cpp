@@ -0,0 +1,144 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "bond.hpp"
+#include "channel.hpp"
+#include "datagram.hpp"
+#include "harness.hpp"
+#include "local.hpp"
+#include "parallel.hpp"
+
+namespace orc {
+
+class Tally :
+    public Bonded
+{
+  public:
+    std::atomic<uint64_t> packets_ = 0;
+
+  protected:
+    void Land(Pipe<Buffer> *pipe, const Buffer &data) override {
+        ++packets_;
+    }
+
+    void Stop() noexcept override {
+    }
+
+  public:
+    using Bonded::Bonded;
+};
+
+// like a server's Incoming: every channel the other side opens is bonded
+class Bonder final :
+    public Peer
+{
+  private:
+    Tally &tally_;
+
+  protected:
+    void Land(rtc::scoped_refptr<webrtc::DataChannelInterface> interface) override {
+        tally_.Bond().Wire<Channel>(shared_from_this(), interface);
+    }
+
+    void Stop(const std::string &error) noexcept override {
+    }
+
+  public:
+    Bonder(S<Origin> origin, Tally &tally) :
+        Peer(std::move(origin)),
+        tally_(tally)
+    {
+    }
+
+    ~Bonder() override {
+        Close();
+    }
+};
+
+static task<void> Flood(Tally &tally, const Buffer &packet, unsigned count) {
+    for (unsigned i(0); i != count; ++i)
+        co_await tally.Send(packet);
+}
+
+// one pair of peers per run, with that many channels between them; each
+// sender is its own UDP flow, so Flow has as many flows to spread as Weighted
+// has packets (and a single flow would, correctly, not be spread at all)
+
+static void Spread(const char *name, unsigned count, unsigned channels, Stripe stripe) {
+    struct Loop {
+        S<Origin> origin_;
+        Tally sender_;
+        Tally receiver_;
+        S<Bonder> client_;
+        S<Bonder> server_;
+    };
+
+    // this is leaked, as tearing WebRTC down is not what is being measured
+    const auto loop(new Loop{Break<Local>(), Tally(stripe), Tally(stripe)});
+
+    Wait([&]() -> task<void> {
+        loop->client_ = Make<Bonder>(loop->origin_, loop->sender_);
+        std::vector<Channel *> wired;
+        for (unsigned i(0); i != channels; ++i)
+            wired.emplace_back(&loop->sender_.Bond().Wire<Channel>(loop->client_));
+        loop->server_ = Make<Bonder>(loop->origin_, loop->receiver_);
+        const auto answer(co_await loop->server_->Answer(Strip(co_await loop->client_->Offer())));
+        co_await loop->client_->Negotiate(answer);
+        for (const auto channel : wired)
+            co_await channel->Open();
+    }());
+
+    static const unsigned Senders(64);
+    const Beam payload(1172);
+    std::vector<Beam> packets;
+    for (unsigned i(0); i != Senders; ++i)
+        packets.emplace_back(Datagram(Socket(Host(10, 7, 0, 1), 1024 + i), Socket(Host(10, 7, 0, 2), 443), payload));
+
+    const std::string label(std::string("bond (") + name + " x" + std::to_string(channels) + ")");
+    const auto seconds(Measure(label.c_str(), count, [&]() {
+        Wait([&]() -> task<void> {
+            std::vector<task<void>> floods;
+            for (unsigned i(0); i != Senders; ++i)
+                floods.emplace_back(Flood(loop->sender_, packets[i], count / Senders + (i < count % Senders ? 1 : 0)));
+            *co_await Parallel(std::move(floods));
+        }());
+    }));
+
+    // give whatever is still in flight a moment to land
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    const uint64_t delivered(loop->receiver_.packets_);
+    std::cout << label << ": " << std::dec << delivered << " of " << count << " delivered = " << uint64_t(delivered * packets[0].size() / seconds / 1024 / 1024) << "MiB/s" << std::endl;
+}
+
+void BenchBond(unsigned count) {
+    for (const unsigned channels : {1, 2, 4, 8})
+        Spread("weighted", count, channels, Stripe::Weighted);
+    for (const unsigned channels : {1, 2, 4, 8})
+        Spread("flow", count, channels, Stripe::Flow);
+}
+
+}
@@ -0,0 +1,213 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "bench.hpp"
+#include "channel.hpp"
+#include "datagram.hpp"
+#include "harness.hpp"
+#include "local.hpp"
+#include "parallel.hpp"
+#include "sleep.hpp"
+
+namespace orc {
+
+static const Socket Client_(Host(10, 7, 0, 1), 1024);
+static const Socket Echo_(Host(10, 7, 0, 2), 7);
+static const Socket Discard_(Host(10, 7, 0, 2), 9);
+
+// counts everything, and sends back what was sent to the echo port
+class Reflector :
+    public Valve,
+    public BufferDrain,
+    public Sunken<Pump<Buffer>>
+{
+  public:
+    std::atomic<uint64_t> packets_ = 0;
+
+  protected:
+    void Land(const Buffer &data) override {
+        ++packets_;
+        Datagram(data, [&](const Socket &source, const Socket &destination, Window window) {
+            if (destination != Echo_)
+                return false;
+            Spawn([this, data = Datagram(destination, source, window)]() noexcept -> task<void> {
+                co_await Inner().Send(data);
+            }, __FUNCTION__);
+            return true;
+        });
+    }
+
+    void Stop(const std::string &error) noexcept override {
+    }
+
+  public:
+    task<void> Shut() noexcept override {
+        co_await Sunken::Shut();
+        co_await Valve::Shut();
+    }
+};
+
+// pings the echo port, one at a time, timing each round trip
+class Pinger :
+    public Valve,
+    public BufferDrain,
+    public Sunken<Pump<Buffer>>
+{
+  public:
+    Histogram *histogram_ = nullptr;
+    std::atomic<unsigned> remaining_ = 0;
+
+  protected:
+    void Land(const Buffer &data) override {
+        Datagram(data, [&](const Socket &source, const Socket &destination, Window window) {
+            const auto [stamp] = Take<uint64_t>(window);
+            histogram_->Record(Bench::Now() - stamp);
+            if (--remaining_ != 0)
+                Ping();
+            return true;
+        });
+    }
+
+    void Stop(const std::string &error) noexcept override {
+    }
+
+  public:
+    void Ping() {
+        Spawn([this]() noexcept -> task<void> {
+            co_await Inner().Send(Datagram(Client_, Echo_, Number<uint64_t>(Bench::Now())));
+        }, __FUNCTION__);
+    }
+
+    task<void> Shut() noexcept override {
+        co_await Sunken::Shut();
+        co_await Valve::Shut();
+    }
+};
+
+class Mirror final :
+    public Peer
+{
+  private:
+    BufferSunk &sunk_;
+
+  protected:
+    void Land(rtc::scoped_refptr<webrtc::DataChannelInterface> interface) override {
+        channel_ = &sunk_.Wire<Channel>(shared_from_this(), interface);
+        landed_();
+    }
+
+    void Stop(const std::string &error) noexcept override {
+    }
+
+  public:
+    Event landed_;
+    Channel *channel_ = nullptr;
+
+    Mirror(S<Origin> origin, BufferSunk &sunk) :
+        Peer(std::move(origin)),
+        sunk_(sunk)
+    {
+    }
+
+    ~Mirror() override {
+        Close();
+    }
+};
+
+static task<void> Flood(Channel &channel, const Buffer &packet, unsigned count) {
+    for (unsigned i(0); i != count; ++i)
+        co_await channel.Send(packet);
+}
+
+// the same pair of peers, the same channel and the same packets; the only
+// difference is whether, once the channel is open, both sides call Raw()
+
+static void Compare(const char *name, unsigned count, bool bypass) {
+    struct Loop {
+        S<Origin> origin_;
+        S<BufferSink<Pinger>> pinger_;
+        S<BufferSink<Reflector>> reflector_;
+        S<Mirror> client_;
+        S<Mirror> server_;
+    };
+
+    // this is leaked, as tearing WebRTC down is not what is being measured
+    const auto loop(new Loop{Break<Local>(), Break<BufferSink<Pinger>>(), Break<BufferSink<Reflector>>()});
+
+    const auto channel(Wait([&]() -> task<Channel *> {
+        loop->client_ = Make<Mirror>(loop->origin_, *loop->pinger_);
+        auto &channel(loop->pinger_->Wire<Channel>(loop->client_));
+        loop->server_ = Make<Mirror>(loop->origin_, *loop->reflector_);
+        const auto answer(co_await loop->server_->Answer(Strip(co_await loop->client_->Offer())));
+        co_await loop->client_->Negotiate(answer);
+        co_await channel.Open();
+        co_await *loop->server_->landed_;
+        const auto other(loop->server_->channel_);
+        co_await other->Open();
+        if (bypass) {
+            *co_await Parallel(channel.Raw(), other->Raw());
+            while (!channel.Bypassed() || !other->Bypassed())
+                co_await Sleep(10);
+        }
+        co_return &channel;
+    }()));
+
+    static const unsigned Senders(64);
+    const auto packet(Datagram(Client_, Discard_, Beam(1172)));
+
+    const auto label(std::string("bypass (") + name + ")");
+    const auto seconds(Measure((label + " send").c_str(), count, [&]() {
+        Wait([&]() -> task<void> {
+            std::vector<task<void>> floods;
+            for (unsigned i(0); i != Senders; ++i)
+                floods.emplace_back(Flood(*channel, packet, count / Senders + (i < count % Senders ? 1 : 0)));
+            *co_await Parallel(std::move(floods));
+        }());
+    }));
+
+    // give whatever is still in flight a moment to land
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    const uint64_t delivered(loop->reflector_->packets_);
+    std::cout << label << " delivered: " << std::dec << delivered << " of " << count << " = " << uint64_t(delivered * packet.size() / seconds / 1024 / 1024) << "MiB/s" << std::endl;
+
+    // a quiet channel, so this is the transport's latency, not its queueing
+    const auto pings(std::max(count / 100, 1u));
+    Histogram &histogram(*new Histogram(bypass ? "bypass" : "sctp"));
+    loop->pinger_->histogram_ = &histogram;
+    loop->pinger_->remaining_ = pings;
+    loop->pinger_->Ping();
+    while (loop->pinger_->remaining_ != 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::cout << label << " rtt: " << histogram.Take() << std::endl;
+}
+
+void BenchBypass(unsigned count) {
+    Compare("sctp", count, false);
+    Compare("dtls", count, true);
+}
+
+}
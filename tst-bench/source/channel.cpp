@@ -0,0 +1,162 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "channel.hpp"
+#include "harness.hpp"
+#include "local.hpp"
+#include "parallel.hpp"
+#include "threads.hpp"
+
+namespace orc {
+
+class Counter :
+    public Valve,
+    public BufferDrain,
+    public Sunken<Pump<Buffer>>
+{
+  public:
+    std::atomic<uint64_t> packets_ = 0;
+
+  protected:
+    void Land(const Buffer &data) override {
+        ++packets_;
+    }
+
+    void Stop(const std::string &error) noexcept override {
+    }
+
+  public:
+    task<void> Shut() noexcept override {
+        co_await Sunken::Shut();
+        co_await Valve::Shut();
+    }
+};
+
+class Loopback final :
+    public Peer
+{
+  private:
+    BufferSunk &sunk_;
+
+  protected:
+    void Land(rtc::scoped_refptr<webrtc::DataChannelInterface> interface) override {
+        sunk_.Wire<Channel>(shared_from_this(), interface);
+    }
+
+    void Stop(const std::string &error) noexcept override {
+    }
+
+  public:
+    Loopback(S<Origin> origin, BufferSunk &sunk) :
+        Peer(std::move(origin)),
+        sunk_(sunk)
+    {
+    }
+
+    ~Loopback() override {
+        Close();
+    }
+};
+
+static task<void> Flood(Channel &channel, const Buffer &packet, unsigned count) {
+    for (unsigned i(0); i != count; ++i)
+        co_await channel.Send(packet);
+}
+
+// the same empty hop onto the signaling thread, one rtc::Message per call
+// (Post) against batched (Signal), which is what Channel::Send changed
+
+static task<void> Posts(unsigned count) {
+    for (unsigned i(0); i != count; ++i)
+        co_await Post([]() noexcept {});
+}
+
+static task<void> Signals(unsigned count) {
+    for (unsigned i(0); i != count; ++i)
+        co_await Signal([]() noexcept {});
+}
+
+// two peers in this process connected by a data channel; many concurrent
+// senders, as a busy server has, is what lets Signal() batch their sends
+
+void BenchChannel(unsigned count) {
+    struct Loop {
+        S<Origin> origin_;
+        S<BufferSink<Counter>> sender_;
+        S<BufferSink<Counter>> receiver_;
+        S<Loopback> client_;
+        S<Loopback> server_;
+    };
+
+    // this is leaked, as tearing WebRTC down is not what is being measured
+    const auto loop(new Loop{Break<Local>(), Break<BufferSink<Counter>>(), Break<BufferSink<Counter>>()});
+
+    const auto channel(Wait([&]() -> task<Channel *> {
+        loop->client_ = Make<Loopback>(loop->origin_, *loop->sender_);
+        auto &channel(loop->sender_->Wire<Channel>(loop->client_));
+        loop->server_ = Make<Loopback>(loop->origin_, *loop->receiver_);
+        const auto answer(co_await loop->server_->Answer(Strip(co_await loop->client_->Offer())));
+        co_await loop->client_->Negotiate(answer);
+        co_await channel.Open();
+        co_return &channel;
+    }()));
+
+    static const unsigned Senders(64);
+
+    const auto spread([&](const char *name, task<void> (*code)(unsigned)) {
+        Measure(name, count, [&]() {
+            Wait([&]() -> task<void> {
+                std::vector<task<void>> senders;
+                for (unsigned i(0); i != Senders; ++i)
+                    senders.emplace_back(code(count / Senders + (i < count % Senders ? 1 : 0)));
+                *co_await Parallel(std::move(senders));
+            }());
+        });
+    });
+
+    spread("channel (post)", &Posts);
+    spread("channel (signal)", &Signals);
+
+    const Beam packet(1200);
+
+    Measure("channel (send)", count, [&]() {
+        Wait([&]() -> task<void> {
+            std::vector<task<void>> floods;
+            for (unsigned i(0); i != Senders; ++i)
+                floods.emplace_back(Flood(*channel, packet, count / Senders + (i < count % Senders ? 1 : 0)));
+            *co_await Parallel(std::move(floods));
+        }());
+    });
+
+    // give whatever is still in flight a moment to land
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    const auto &receiver(*loop->receiver_);
+    std::cout << "channel (delivered): " << std::dec << receiver.packets_ << " of " << count << std::endl;
+}
+
+}
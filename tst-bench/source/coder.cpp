@@ -0,0 +1,51 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include "crypto.hpp"
+#include "harness.hpp"
+#include "jsonrpc.hpp"
+
+namespace orc {
+
+void BenchCoder(unsigned count) {
+    using Ticket = Coder<Bytes32, Bytes32, uint256_t, Bytes32, Address, uint256_t, uint128_t, uint128_t, uint256_t, uint128_t, Address, Address, Bytes>;
+
+    const auto orchid(Hash("Orchid.grab"));
+    const auto commit(Random<32>());
+    const auto nonce(Random<32>());
+    const Address lottery("0xb02396f06cc894834b7934ecf8c8e5ab5c1d12f1");
+    const Address funder(Random<20>().num<uint160_t>());
+    const Address recipient(Random<20>().num<uint160_t>());
+    const Beam receipt(Random<64>());
+
+    Measure("coder (ticket)", count, [&]() {
+        for (unsigned i(0); i != count; ++i)
+            Hash(Ticket::Encode(orchid, commit, i, nonce, lottery, 1, 100, 200, i, 300, funder, recipient, receipt));
+    });
+
+    Measure("coder (packed)", count, [&]() {
+        for (unsigned i(0); i != count; ++i)
+            Hash(Coder<Address, Address>::Pack(funder, recipient));
+    });
+}
+
+}
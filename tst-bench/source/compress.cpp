@@ -0,0 +1,178 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include <string>
+#include <vector>
+
+#include "compress.hpp"
+#include "crypto.hpp"
+#include "datagram.hpp"
+#include "harness.hpp"
+#include "spawn.hpp"
+
+namespace orc {
+
+class Count :
+    public BufferDrain
+{
+  public:
+    uint64_t bytes_ = 0;
+
+  protected:
+    void Land(const Buffer &data) override {
+        bytes_ += data.size();
+    }
+
+    void Stop(const std::string &error) noexcept override {
+    }
+};
+
+// stands in for a Channel, keeping one pass over the trace to land later
+class Tape :
+    public Pump<Buffer>
+{
+  public:
+    const size_t length_;
+    std::vector<Beam> frames_;
+    uint64_t bytes_ = 0;
+
+    Tape(BufferDrain &drain, size_t length) :
+        Pump<Buffer>(drain),
+        length_(length)
+    {
+    }
+
+    task<void> Shut() noexcept override {
+        co_return;
+    }
+
+    task<void> Send(const Buffer &data) override {
+        bytes_ += data.size();
+        if (frames_.size() != length_)
+            frames_.emplace_back(data);
+        co_return;
+    }
+};
+
+// these are made up, but are shaped like the traffic this is meant for: DNS
+// lookups, the headers of plaintext HTTP, and TLS (which it can't help with)
+
+static std::vector<Beam> Lookups(unsigned count) {
+    static const char *const names[] = {"www.google.com", "fonts.gstatic.com", "api.twitter.com", "cdn.jsdelivr.net", "en.wikipedia.org", "s3.amazonaws.com"};
+    std::vector<Beam> packets;
+    for (unsigned i(0); i != count; ++i) {
+        std::string query("\x00\x00\x01\x00\x00\x01\x00\x00\x00\x00\x00\x00", 12);
+        query[0] = char(i >> 8);
+        query[1] = char(i);
+        const std::string name(names[i % (sizeof(names) / sizeof(names[0]))]);
+        for (size_t label(0); label < name.size(); ) {
+            const auto dot(std::min(name.find('.', label), name.size()));
+            query += char(dot - label);
+            query += name.substr(label, dot - label);
+            label = dot + 1;
+        }
+        query += std::string("\x00\x00\x01\x00\x01", 5);
+        packets.emplace_back(Datagram(Socket(Host(10, 7, 0, 1), 1024 + i % 512), Socket(Host(1, 1, 1, 1), 53), Subset(query)));
+    }
+    return packets;
+}
+
+static std::vector<Beam> Requests(unsigned count) {
+    std::vector<Beam> packets;
+    for (unsigned i(0); i != count; ++i) {
+        const auto request("GET /static/" + std::to_string(i * 7919 % 100000) + ".js HTTP/1.1\r\n"
+            "Host: example.com\r\n"
+            "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:78.0) Gecko/20100101 Firefox/78.0\r\n"
+            "Accept: */*\r\n"
+            "Accept-Language: en-US,en;q=0.5\r\n"
+            "Accept-Encoding: gzip, deflate\r\n"
+            "Referer: http://example.com/index.html\r\n"
+            "Cookie: session=" + std::to_string(i * 104729) + "; theme=dark\r\n"
+            "Connection: keep-alive\r\n"
+            "\r\n");
+        packets.emplace_back(Datagram(Socket(Host(10, 7, 0, 1), 1024 + i % 512), Socket(Host(93, 184, 216, 34), 80), Subset(request)));
+    }
+    return packets;
+}
+
+static std::vector<Beam> Records(unsigned count) {
+    std::vector<Beam> packets;
+    Beam payload(1172);
+    for (unsigned i(0); i != count; ++i) {
+        Random(payload.data(), payload.size());
+        packets.emplace_back(Datagram(Socket(Host(10, 7, 0, 1), 1024 + i % 512), Socket(Host(93, 184, 216, 34), 443), payload));
+    }
+    return packets;
+}
+
+static void Play(const char *name, const std::vector<Beam> &packets, unsigned count, int acceleration) {
+    Compression compression;
+    compression.acceleration_ = acceleration;
+
+    // these are leaked, as a Sink wants to be Shut, which isn't being measured
+    const auto sink(new Count());
+    const auto sender(new Covered<BufferSink<Compress>>(*sink, compression));
+    const auto receiver(new Covered<BufferSink<Compress>>(*sink, compression));
+    auto &tape(sender->Wire<Tape>(packets.size()));
+
+    uint64_t saved(0);
+    sender->Engage([&](size_t size) { saved += size; });
+
+    uint64_t bytes(0);
+    for (unsigned i(0); i != count; ++i)
+        bytes += packets[i % packets.size()].size();
+
+    const std::string label(std::string("compress (") + name + " x" + std::to_string(acceleration) + ")");
+    Measure(label.c_str(), count, [&]() {
+        Wait([&]() -> task<void> {
+            for (unsigned i(0); i != count; ++i)
+                co_await sender->Send(packets[i % packets.size()]);
+        }());
+    });
+
+    std::cout << label << ": " << std::dec << bytes << " to " << tape.bytes_ << " bytes = " << std::fixed << std::setprecision(3) << double(tape.bytes_) / bytes << " (" << saved << " refunded)" << std::endl;
+
+    const std::string expand(std::string("expand (") + name + " x" + std::to_string(acceleration) + ")");
+    Measure(expand.c_str(), count, [&]() {
+        for (unsigned i(0); i != count; ++i)
+            static_cast<BufferDrain &>(*receiver).Land(tape.frames_[i % tape.frames_.size()]);
+    });
+}
+
+void BenchCompress(unsigned count) {
+    const auto lookups(Lookups(1024));
+    const auto requests(Requests(1024));
+    const auto records(Records(1024));
+
+    std::vector<Beam> mixed;
+    for (unsigned i(0); i != 1024; ++i)
+        mixed.emplace_back(i % 4 == 0 ? Beam(lookups[i]) : i % 4 == 1 ? Beam(requests[i]) : Beam(records[i]));
+
+    for (const int acceleration : {1, 8}) {
+        Play("dns", lookups, count, acceleration);
+        Play("http", requests, count, acceleration);
+        Play("tls", records, count, acceleration);
+        Play("mixed", mixed, count, acceleration);
+    }
+}
+
+}
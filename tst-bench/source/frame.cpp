@@ -0,0 +1,54 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include <atomic>
+#include <thread>
+
+#include "frame.hpp"
+#include "harness.hpp"
+#include "spawn.hpp"
+
+namespace orc {
+
+static task<unsigned> Inner(unsigned value) {
+    co_return value + 1;
+}
+
+void BenchFrame(unsigned count) {
+    std::atomic<unsigned> done(0);
+    const auto before(Frames::Allocated());
+
+    Measure("frame (spawn)", count, [&]() {
+        for (unsigned i(0); i != count; ++i)
+            Spawn([&, i]() noexcept -> task<void> {
+                co_await Inner(i);
+                ++done;
+            }, "BenchFrame");
+
+        while (done != count)
+            std::this_thread::yield();
+    });
+
+    std::cout << "frame (heap): " << double(Frames::Allocated() - before) / count << " allocations per spawn" << std::endl;
+}
+
+}
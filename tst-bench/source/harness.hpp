@@ -0,0 +1,58 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#ifndef ORCHID_HARNESS_HPP
+#define ORCHID_HARNESS_HPP
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace orc {
+
+template <typename Code_>
+double Measure(const char *name, uint64_t count, Code_ &&code) {
+    const auto start(std::chrono::steady_clock::now());
+    code();
+    const std::chrono::duration<double> duration(std::chrono::steady_clock::now() - start);
+    const auto seconds(duration.count());
+    std::cout << name << ": " << std::dec << count << " in " << std::fixed << std::setprecision(3) << seconds << "s = " << uint64_t(count / seconds) << "/s" << std::endl;
+    return seconds;
+}
+
+void BenchBond(unsigned count);
+void BenchBypass(unsigned count);
+void BenchChannel(unsigned count);
+void BenchCoder(unsigned count);
+void BenchCompress(unsigned count);
+void BenchFrame(unsigned count);
+void BenchKeccak(unsigned count);
+void BenchLazy(unsigned count);
+void BenchLwip(unsigned count);
+void BenchProof(unsigned count);
+void BenchRemote(unsigned count);
+void BenchSchedule(unsigned count);
+void BenchWheel(unsigned count);
+
+}
+
+#endif//ORCHID_HARNESS_HPP
@@ -0,0 +1,74 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include <vector>
+
+#include "crypto.hpp"
+#include "harness.hpp"
+#include "jsonrpc.hpp"
+#include "keccak.hpp"
+
+namespace orc {
+
+void BenchKeccak(unsigned count) {
+    const auto reveal(Random<32>());
+    const uint256_t issued(Timestamp());
+    const auto nonce(Random<32>());
+
+    Measure("keccak (flattened ticket)", count, [&]() {
+        for (unsigned i(0); i != count; ++i)
+            Hash(Beam(Tie(reveal, issued, nonce)));
+    });
+
+    Measure("keccak (streamed ticket)", count, [&]() {
+        for (unsigned i(0); i != count; ++i)
+            Hash(Tie(reveal, issued, nonce));
+    });
+
+    for (const size_t size : {96, 532}) {
+        std::vector<Beam> beams;
+        std::vector<const Region *> data;
+        for (unsigned i(0); i != 64; ++i) {
+            Beam beam(size);
+            Random(beam.data(), beam.size());
+            beams.emplace_back(std::move(beam));
+        }
+        for (const auto &beam : beams)
+            data.emplace_back(&beam);
+        std::vector<Brick<32>> hashes(data.size());
+
+        const auto rounds((count + data.size() - 1) / data.size());
+
+        Measure(size == 96 ? "keccak (96 bytes, single)" : "keccak (532 bytes, single)", rounds * data.size(), [&]() {
+            for (unsigned i(0); i != rounds; ++i)
+                for (size_t j(0); j != data.size(); ++j)
+                    hashes[j] = Hash(*data[j]);
+        });
+
+        Measure(size == 96 ? "keccak (96 bytes, multi)" : "keccak (532 bytes, multi)", rounds * data.size(), [&]() {
+            for (unsigned i(0); i != rounds; ++i)
+                Hash(hashes.data(), data.data(), data.size());
+        });
+    }
+}
+
+}
@@ -0,0 +1,57 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+
+
+#include "harness.hpp"
+#include "json.hpp"
+#include "lazy.hpp"
+
+namespace orc {
+
+void BenchLazy(unsigned count) {
+    // a typical eth_subscription log notification as the cashier receives it
+    const std::string message(R"({"jsonrpc":"2.0","method":"eth_subscription","params":{"subscription":"0x9ce59a13059e417087c02d3236a0b1cc","result":{"address":"0xb02396f06cc894834b7934ecf8c8e5ab5c1d12f1","topics":["0x3cd5941d0d99319105eba5f5393ed93c883f132d251e56819e516005c5e20dbc","0x0000000000000000000000002b1ce95573ec1b927a90cb488db113b40eeb064a","0x000000000000000000000000b02396f06cc894834b7934ecf8c8e5ab5c1d12f1"],"data":"0x0000000000000000000000000000000000000000000000056bc75e2d63100000000000000000000000000000000000000000000000000002b5e3af16b18800000000000000000000000000000000000000000000000000000000000000000000","blockNumber":"0x8c5be1","transactionHash":"0x2b5e3af16b1880000b02396f06cc894834b7934ecf8c8e5ab5c1d12f13cd5941","transactionIndex":"0x1d","blockHash":"0x1880000b02396f06cc894834b7934ecf8c8e5ab5c1d12f13cd5941d0d9931910","logIndex":"0x2a","removed":false}}})");
+
+    size_t total(0);
+
+    Measure("lazy (Json::Value)", count, [&]() {
+        for (unsigned i(0); i != count; ++i) {
+            const auto data(Parse(message));
+            const auto result(data["params"]["result"]);
+            total += data["id"].isNull() + data["method"].asString().size() + result["topics"][2].asString().size() + result["data"].asString().size();
+        }
+    });
+
+    Measure("lazy (Index)", count, [&]() {
+        for (unsigned i(0); i != count; ++i) {
+            const Index index(message);
+            const auto data(*index);
+            const auto result(data["params"]["result"]);
+            total += data["id"].isNull() + data["method"].raw().size() + result["topics"][2].raw().size() + result["data"].raw().size();
+        }
+    });
+
+    orc_assert(total != 0);
+}
+
+}
@@ -0,0 +1,99 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <rtc_base/async_socket.h>
+
+#include "harness.hpp"
+#include "lwip.hpp"
+#include "remote.hpp"
+
+namespace orc {
+
+// reads what it is told it can, then gets Wait to return as a message would
+class Reader :
+    public sigslot::has_slots<>
+{
+  private:
+    LwipSocketServer &server_;
+
+  public:
+    Reader(LwipSocketServer &server) :
+        server_(server)
+    {
+    }
+
+    void OnRead(rtc::AsyncSocket *socket) {
+        uint8_t data[16];
+        orc_assert(socket->Recv(data, sizeof(data), nullptr) > 0);
+        server_.WakeUp();
+    }
+};
+
+static U<rtc::AsyncSocket> Bound(LwipSocketServer &server, const rtc::SocketAddress &address) {
+    U<rtc::AsyncSocket> socket(server.CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+    orc_assert(socket != nullptr);
+    orc_assert(socket->Bind(address) == 0);
+    return socket;
+}
+
+static void Ping(LwipSocketServer &server, const rtc::SocketAddress &address, unsigned idle, unsigned count) {
+    std::vector<U<rtc::AsyncSocket>> idles;
+    for (unsigned i(0); i != idle; ++i)
+        idles.emplace_back(Bound(server, address));
+    // each new socket is looked at once, and found writable
+    server.Wait(0, true);
+
+    const auto receiver(Bound(server, address));
+    Reader reader(server);
+    receiver->SignalReadEvent.connect(&reader, &Reader::OnRead);
+
+    const auto sender(Bound(server, address));
+    orc_assert(sender->Connect(receiver->GetLocalAddress()) == 0);
+
+    const std::string label("lwip (" + std::to_string(idle) + " idle)");
+    Measure(label.c_str(), count, [&]() {
+        const uint8_t data(0);
+        for (unsigned i(0); i != count; ++i) {
+            orc_assert(sender->Send(&data, sizeof(data)) == sizeof(data));
+            server.Wait(rtc::SocketServer::kForever, true);
+        }
+    });
+}
+
+void BenchLwip(unsigned count) {
+    // this is leaked, as tearing lwIP down is not what is being measured
+    auto &remote(*new Covered<BufferSink<Remote>>());
+    remote.Open();
+
+    LwipSocketServer server;
+    const rtc::SocketAddress address(remote.Host(), 0);
+
+    // a select() over every socket paid for each of these on each wakeup
+    Ping(server, address, 0, count);
+    Ping(server, address, 4000, count);
+}
+
+}
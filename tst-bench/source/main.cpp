@@ -0,0 +1,72 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include <map>
+#include <string>
+
+#include "error.hpp"
+#include "harness.hpp"
+#include "integer.hpp"
+
+namespace orc {
+
+int Main(int argc, const char *const argv[]) {
+    orc_assert(argc == 2 || argc == 3);
+    const std::string name(argv[1]);
+    const unsigned count(argc == 3 ? To(argv[2]) : 100000);
+
+    static const std::map<std::string, void (*)(unsigned)> benches{
+        {"bond", &BenchBond},
+        {"bypass", &BenchBypass},
+        {"channel", &BenchChannel},
+        {"coder", &BenchCoder},
+        {"compress", &BenchCompress},
+        {"frame", &BenchFrame},
+        {"keccak", &BenchKeccak},
+        {"lazy", &BenchLazy},
+        {"lwip", &BenchLwip},
+        {"proof", &BenchProof},
+        {"remote", &BenchRemote},
+        {"schedule", &BenchSchedule},
+        {"wheel", &BenchWheel},
+    };
+
+    if (name == "all")
+        for (const auto &bench : benches)
+            bench.second(count);
+    else {
+        const auto bench(benches.find(name));
+        orc_assert_(bench != benches.end(), "unknown benchmark " << name);
+        bench->second(count);
+    }
+
+    return 0;
+}
+
+}
+
+int main(int argc, const char *const argv[]) { try {
+    return orc::Main(argc, argv);
+} catch (const std::exception &error) {
+    std::cerr << error.what() << std::endl;
+    return 1;
+} }
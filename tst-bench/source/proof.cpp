@@ -0,0 +1,87 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include "crypto.hpp"
+#include "harness.hpp"
+#include "jsonrpc.hpp"
+#include "proof.hpp"
+
+namespace orc {
+
+// a two-level trie: one branch node with a leaf in each of its sixteen slots
+
+void BenchProof(unsigned count) {
+    std::vector<uint256_t> keys;
+    std::vector<std::string> leaves(16);
+
+    for (uint256_t key(0); keys.size() != 16; ++key) {
+        const auto path(Hash(Number<uint256_t>(key)));
+        auto &leaf(leaves[path.nib(0)]);
+        if (!leaf.empty())
+            continue;
+
+        std::string leg(path.size(), '\0');
+        path.copy(leg.data(), leg.size());
+        leg[0] = char(0x30 | path.nib(1));
+        leaf = Implode({leg, Implode(uint8_t(keys.size() + 1))});
+        keys.emplace_back(key);
+    }
+
+    std::vector<Nested> slots;
+    for (const auto &leaf : leaves)
+        slots.emplace_back(Hash(leaf).str());
+    slots.emplace_back("");
+
+    const auto branch(Implode(Nested(false, {}, std::move(slots))));
+    const auto root(Hash(branch));
+
+    Json::Value storages(Json::arrayValue);
+    for (unsigned i(0); i != keys.size(); ++i) {
+        Json::Value storage;
+        storage["key"] = "0x" + keys[i].str(0, std::ios::hex);
+        storage["value"] = i + 1;
+        storage["proof"][0] = Subset(branch).hex();
+        storage["proof"][1] = Subset(leaves[Hash(Number<uint256_t>(keys[i])).nib(0)]).hex();
+        storages[i] = storage;
+    }
+
+    Json::Value response;
+    response["accountProof"] = Json::arrayValue;
+    response["storageProof"] = storages;
+
+    Measure("proof (decode+verify)", uint64_t(count) * keys.size(), [&]() {
+        for (unsigned i(0); i != count; ++i) {
+            const Proof proof(response);
+            for (unsigned j(0); j != keys.size(); ++j)
+                orc_assert(proof.Verify(root, Hash(Number<uint256_t>(keys[j]))).num() == j + 1);
+        }
+    });
+
+    const Proof proof(response);
+    Measure("proof (verify)", uint64_t(count) * keys.size(), [&]() {
+        for (unsigned i(0); i != count; ++i)
+            for (unsigned j(0); j != keys.size(); ++j)
+                orc_assert(proof.Verify(root, Hash(Number<uint256_t>(keys[j]))).num() == j + 1);
+    });
+}
+
+}
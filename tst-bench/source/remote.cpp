@@ -0,0 +1,125 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <lwip/tcp.h>
+#include <lwip/tcpip.h>
+
+#include "harness.hpp"
+#include "remote.hpp"
+
+namespace orc {
+
+// stands in for a tunnel, landing what one Remote sends on the other
+class Cross :
+    public Pump<Buffer>
+{
+  private:
+    BufferDrain &other_;
+
+  public:
+    Cross(BufferDrain &drain, BufferDrain &other) :
+        Pump<Buffer>(drain),
+        other_(other)
+    {
+    }
+
+    task<void> Shut() noexcept override {
+        co_return;
+    }
+
+    task<void> Send(const Buffer &data) override {
+        other_.Land(data);
+        co_return;
+    }
+};
+
+static std::atomic<uint64_t> received_(0);
+
+// lwIP's raw API, as Remote can't listen; this only counts what arrives
+static void Listen(const Host &host, uint16_t port) {
+    LOCK_TCPIP_CORE();
+    const auto pcb(tcp_new());
+    orc_assert(pcb != nullptr);
+    ip4_addr_t address(host);
+    orc_assert(tcp_bind(pcb, &address, port) == ERR_OK);
+    const auto listener(tcp_listen(pcb));
+    orc_assert(listener != nullptr);
+    tcp_accept(listener, [](void *arg, tcp_pcb *pcb, err_t error) noexcept -> err_t {
+        tcp_recv(pcb, [](void *arg, tcp_pcb *pcb, pbuf *data, err_t error) noexcept -> err_t {
+            if (data == nullptr)
+                return tcp_close(pcb);
+            received_ += data->tot_len;
+            tcp_recved(pcb, data->tot_len);
+            pbuf_free(data);
+            return ERR_OK;
+        });
+        return ERR_OK;
+    });
+    UNLOCK_TCPIP_CORE();
+}
+
+static void Pour(const char *name, Remote &remote, const Socket &endpoint, unsigned count, size_t holds) {
+    Holds(holds);
+    const Beam chunk(64 * 1024);
+    const uint64_t total(uint64_t(count) * 1024 / chunk.size() * chunk.size());
+
+    received_ = 0;
+    const uint64_t before(copied_);
+
+    const std::string label(std::string("remote (") + name + ")");
+    const auto seconds(Measure(label.c_str(), total / chunk.size(), [&]() {
+        Wait([&]() -> task<void> {
+            // this is leaked, as Remote's connections can't yet be closed
+            const auto stream((co_await remote.Connect(endpoint)).release());
+            for (uint64_t sent(0); sent != total; sent += chunk.size())
+                co_await stream->Send(chunk);
+        }());
+
+        while (received_ != total)
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }));
+
+    std::cout << label << ": " << std::dec << uint64_t(total / seconds / 1024 / 1024) << "MiB/s, " << std::fixed << std::setprecision(2) << double(copied_ - before) / total << " copies per byte" << std::endl;
+}
+
+void BenchRemote(unsigned count) {
+    // these are leaked, as tearing lwIP down is not what is being measured
+    auto &near(*new Covered<BufferSink<Remote>>());
+    auto &far(*new Covered<BufferSink<Remote>>());
+    near.Wire<Cross>(static_cast<BufferDrain &>(far));
+    far.Wire<Cross>(static_cast<BufferDrain &>(near));
+    near.Open();
+    far.Open();
+
+    const Socket endpoint(far.Host(), 7);
+    Listen(endpoint.Host(), endpoint.Port());
+
+    Pour("copied", near, endpoint, count, 0);
+    Pour("held", near, endpoint, count, 64 * 1024);
+}
+
+}
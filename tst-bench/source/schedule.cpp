@@ -0,0 +1,101 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "harness.hpp"
+#include "spawn.hpp"
+
+namespace orc {
+
+static uint64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void BenchSchedule(unsigned count) {
+    std::vector<uint64_t> spawned(count);
+    std::vector<uint64_t> resumed(count);
+    std::vector<unsigned> order(count);
+    std::atomic<unsigned> position(0);
+    std::atomic<unsigned> done(0);
+
+    Measure("schedule", count, [&]() {
+        for (unsigned i(0); i != count; ++i) {
+            spawned[i] = Now();
+            Spawn([&, i]() noexcept -> task<void> {
+                resumed[i] = Now();
+                order[position++] = i;
+                ++done;
+                co_return;
+            }, "BenchSchedule");
+        }
+
+        while (done != count)
+            std::this_thread::yield();
+    });
+
+    std::vector<uint64_t> latency(count);
+    for (unsigned i(0); i != count; ++i)
+        latency[i] = resumed[i] - spawned[i];
+    std::sort(latency.begin(), latency.end());
+    const auto at([&](double fraction) {
+        return double(latency[size_t((count - 1) * fraction)]) / 1000;
+    });
+    std::cout << "schedule (spawn to resume): p50 = " << at(0.50) << "us, p99 = " << at(0.99) << "us, max = " << at(1) << "us" << std::endl;
+
+    // with FIFO scheduling this is bounded by the amount of work in flight
+    uint64_t total(0);
+    unsigned worst(0);
+    for (unsigned i(0); i != count; ++i) {
+        const auto displacement(order[i] > i ? order[i] - i : i - order[i]);
+        total += displacement;
+        worst = std::max(worst, displacement);
+    }
+    std::cout << "schedule (displacement): mean = " << double(total) / count << ", max = " << worst << std::endl;
+
+    // a flood of background work with data-plane work sprinkled through it
+    Delay before[Priorities];
+    for (size_t priority(0); priority != Priorities; ++priority)
+        before[priority] = Delayed(Priority(priority));
+
+    done = 0;
+    for (unsigned i(0); i != count; ++i)
+        Spawn([&]() noexcept -> task<void> {
+            ++done;
+            co_return;
+        }, "BenchSchedule", i % 10 == 0 ? Priority::Data : Priority::Background);
+
+    while (done != count)
+        std::this_thread::yield();
+
+    for (size_t priority(0); priority != Priorities; ++priority) {
+        const auto after(Delayed(Priority(priority)));
+        const auto spawned(after.count_ - before[priority].count_);
+        if (spawned != 0)
+            std::cout << "schedule (" << Name(Priority(priority)) << "): " << spawned << " with mean delay = " << double(after.total_ - before[priority].total_) / spawned / 1000 << "us" << std::endl;
+    }
+}
+
+}
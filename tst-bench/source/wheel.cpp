@@ -0,0 +1,75 @@
+/* Orchid - WebRTC P2P VPN Market (on Ethereum)
+ * Copyright (C) 2017-2019  The Orchid Authors
+*/
+
+/* GNU Affero General Public License, Version 3 {{{ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/* }}} */
+
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "harness.hpp"
+#include "wheel.hpp"
+
+namespace orc {
+
+void BenchWheel(unsigned count) {
+    typedef std::chrono::steady_clock Clock;
+
+    std::atomic<unsigned> fired(0);
+    std::atomic<uint64_t> late(0);
+    std::atomic<uint64_t> worst(0);
+
+    std::vector<Clock::time_point> deadlines(count);
+    std::vector<std::unique_ptr<Timer>> timers;
+    timers.reserve(count);
+
+    for (unsigned i(0); i != count; ++i)
+        timers.emplace_back(new Timer([&, i]() {
+            const uint64_t lateness((Clock::now() - deadlines[i]) / std::chrono::microseconds(1));
+            late += lateness;
+            for (auto maximum(worst.load()); lateness > maximum && !worst.compare_exchange_weak(maximum, lateness); );
+            ++fired;
+        }));
+
+    // spread the deadlines over a second, as tunnels and flows would be
+    Measure("wheel (arm)", count, [&]() {
+        for (unsigned i(0); i != count; ++i) {
+            const auto delay(100 + i * 997 % 1000);
+            deadlines[i] = Clock::now() + std::chrono::milliseconds(delay);
+            timers[i]->Set(delay);
+        }
+    });
+
+    const auto cancel(count / 2);
+    Measure("wheel (cancel)", cancel, [&]() {
+        for (unsigned i(0); i != cancel; ++i)
+            timers[i * 2]->Cancel();
+    });
+
+    const auto expected(count - cancel);
+    while (fired != expected)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    std::cout << "wheel (late): " << late / expected / 1000.0 << "ms mean, " << worst / 1000.0 << "ms worst" << std::endl;
+}
+
+}
@@ -20,18 +20,23 @@
 /* }}} */
 
 
+#include <optional>
+#include <unordered_map>
+
 #include <cppcoro/async_latch.hpp>
-#include <cppcoro/async_mutex.hpp>
 
 #include <openvpn/addr/ipv4.hpp>
 
 #include <dns.h>
 
 #include "acceptor.hpp"
+#include "bond.hpp"
 #include "boring.hpp"
 #include "datagram.hpp"
 #include "capture.hpp"
 #include "client.hpp"
+#include "coalesce.hpp"
+#include "compress.hpp"
 #include "connection.hpp"
 #include "database.hpp"
 #include "directory.hpp"
@@ -39,6 +44,7 @@
 #include "heap.hpp"
 #include "load.hpp"
 #include "local.hpp"
+#include "locked.hpp"
 #include "monitor.hpp"
 #include "network.hpp"
 #include "origin.hpp"
@@ -231,7 +237,7 @@ void Capture::Land(const Buffer &data) {
     if (internal_) nest_.Hatch([&]() noexcept { return [this, data = Beam(data)]() mutable -> task<void> {
         if (co_await internal_->Send(data))
             analyzer_->Analyze(data.span());
-    }; }, __FUNCTION__);
+    }; }, __FUNCTION__, Priority::Data);
 }
 
 void Capture::Stop(const std::string &error) noexcept {
@@ -245,12 +251,12 @@ void Capture::Land(const Buffer &data, bool analyze) {
         co_await Inner().Send(data);
         if (analyze)
             analyzer_->AnalyzeIncoming(data.span());
-    }; }, __FUNCTION__);
+    }; }, __FUNCTION__, Priority::Data);
 }
 
 Capture::Capture(const Host &local) :
     local_(local),
-    nest_(32),
+    nest_(32, Admission::Oldest, 256),
     analyzer_(std::make_unique<Nameless>(Group() + "/analysis.db"))
 {
 }
@@ -359,47 +365,74 @@ class Split :
     const S<Origin> origin_;
 
     Socket local_;
-    asio::ip::address_v4 remote_;
-
-    typedef std::list<Four> LRU_;
+    Host remote_;
+
+    // a Four hashes to a shard, and that shard hands out the ephemeral ports
+    // congruent to its index, so both directions of a flow meet on one lock
+    static const size_t Shards_ = 64;
+    static const size_t Slots_ = 65536 / Shards_;
+
+    // a port stays taken by its Four after the Flow is Pull()ed (so what
+    // the client still sends for it has somewhere to go) until reclaimed
+    struct Slot_ {
+        std::optional<Four> four_;
+        S<Flow> flow_;
+        // reference bit for the CLOCK hand
+        bool used_ = false;
+    };
 
-    struct Ephemeral_ {
-        Socket socket_;
-        LRU_::iterator lru_iter_;
+    struct Shard_ {
+        std::unordered_map<Four, uint16_t> ports_;
+        std::array<Slot_, Slots_> slots_;
+        size_t hand_ = 0;
     };
 
-    cppcoro::async_mutex meta_;
-    std::map<Four, Ephemeral_> ephemerals_;
-    std::map<Socket, S<Flow>> flows_;
+    std::array<Locked<Shard_>, Shards_> shards_;
     std::map<Socket, U<Punch>> udp_;
-    LRU_ lru_;
-
-    void RemoveFlow(const Four &four) noexcept {
-        const auto ephemeral(ephemerals_.find(four));
-        orc_insist(ephemeral != ephemerals_.end());
-        const auto flow(flows_.find(ephemeral->second.socket_));
-        orc_insist(flow != flows_.end());
-        flows_.erase(flow);
+
+    static size_t Index(const Four &four) {
+        return std::hash<Four>()(four) % Shards_;
+    }
+
+    // sweeps past recently used slots (clearing their bits) until it finds
+    // a free one or evicts the first flow that went a full turn untouched
+    static uint16_t Claim(Shard_ &shard, size_t index) {
+        for (;;) {
+            const auto slot(shard.hand_);
+            shard.hand_ = (slot + 1) % Slots_;
+            const uint16_t port(slot * Shards_ + index);
+            // port 0 is not valid
+            if (port == 0)
+                continue;
+            auto &entry(shard.slots_[slot]);
+            if (entry.four_) {
+                if (entry.used_) {
+                    entry.used_ = false;
+                    continue;
+                }
+                shard.ports_.erase(*entry.four_);
+                entry = Slot_();
+            }
+            return port;
+        }
     }
 
-    void RemoveEmphemeral(const Four &four) {
-        const auto ephemeral(ephemerals_.find(four));
-        orc_insist(ephemeral != ephemerals_.end());
-        flows_.erase(ephemeral->second.socket_);
-        lru_.erase(ephemeral->second.lru_iter_);
-        ephemerals_.erase(ephemeral);
+    S<Flow> Find(const Socket &socket) {
+        if (!(socket.Host() == remote_))
+            return nullptr;
+        const auto port(socket.Port());
+        const auto shard(shards_[port % Shards_]());
+        auto &slot(shard->slots_[port / Shards_]);
+        if (slot.flow_ == nullptr)
+            return nullptr;
+        slot.used_ = true;
+        return slot.flow_;
     }
 
   protected:
     void Land(asio::ip::tcp::socket connection, Socket socket) override {
         Spawn([this, connection = std::move(connection), socket]() mutable noexcept -> task<void> {
-            const auto flow(co_await [&]() noexcept -> task<S<Flow>> {
-                const auto lock(co_await meta_.scoped_lock_async());
-                const auto flow(flows_.find(socket));
-                if (flow == flows_.end())
-                    co_return nullptr;
-                co_return flow->second;
-            }());
+            const auto flow(Find(socket));
             if (flow == nullptr)
                 co_return;
             flow->down_ = std::make_unique<Connection>(std::move(connection));
@@ -424,16 +457,16 @@ class Split :
     void Land(const Buffer &data) override;
     task<bool> Send(const Beam &data) override;
 
-    void EphemeralUsed(const Four &four) {
-        auto emphemeral_iter(ephemerals_.find(four));
-        lru_.erase(emphemeral_iter->second.lru_iter_);
-        lru_.push_back(emphemeral_iter->first);
-        emphemeral_iter->second.lru_iter_ = std::prev(lru_.end());
-    }
-
     task<void> Pull(const Four &four) noexcept override {
-        const auto lock(co_await meta_.scoped_lock_async());
-        RemoveFlow(four);
+        // this might be the last reference (and four is the Flow's), so it
+        // is only released once this returns, and outside the lock
+        S<Flow> flow;
+        { const auto shard(shards_[Index(four)]());
+            const auto port(shard->ports_.find(four));
+            // the CLOCK hand might have already taken this port back
+            if (port != shard->ports_.end())
+                flow = std::move(shard->slots_[port->second / Shards_].flow_); }
+        co_return;
     }
 
     // https://www.snellman.net/blog/archive/2016-02-01-tcp-rst/
@@ -488,7 +521,7 @@ void Split::Connect(const Host &local) {
     Acceptor::Open({local, 0});
     local_ = Local();
     // XXX: this is sickening
-    remote_ = asio::ip::address_v4(local_.Host().operator uint32_t() + 1);
+    remote_ = local_.Host().operator uint32_t() + 1;
 }
 
 task<void> Split::Shut() noexcept {
@@ -519,43 +552,46 @@ task<bool> Split::Send(const Beam &data) {
             );
 
             if (four.Source() == local_) {
-                const auto lock(co_await meta_.scoped_lock_async());
-                const auto flow(flows_.find(four.Target()));
-                if (flow == flows_.end())
+                const auto flow(Find(four.Target()));
+                if (flow == nullptr)
                     break;
-                orc_insist(flow->second != nullptr);
-                const auto &original(flow->second->four_);
-                EphemeralUsed(original);
+                const auto &original(flow->four_);
                 Forge(span, tcp, original.Target(), original.Source());
                 capture_->Land(subset, true);
                 co_return false;
             }
 
-            const auto lock(co_await meta_.scoped_lock_async());
-            const auto ephemeral(ephemerals_.find(four));
+            const auto syn((tcp.flags & openvpn::TCPHeader::FLAG_SYN) != 0);
+            const auto index(Index(four));
 
-            if ((tcp.flags & openvpn::TCPHeader::FLAG_SYN) == 0) {
-                if (ephemeral == ephemerals_.end())
-                    break;
-                EphemeralUsed(four);
-                Forge(span, tcp, ephemeral->second.socket_, local_);
-                capture_->Land(subset, false);
-            } else if (ephemeral == ephemerals_.end()) {
-                // port 0 is not valid
-                auto port(ephemerals_.size() + 1);
-                if (port >= 65535 - 1) {
-                    const auto old_four(*lru_.begin());
-                    auto old_ephemeral(ephemerals_.find(old_four));
-                    port = old_ephemeral->second.socket_.Port();
-                    RemoveEmphemeral(old_four);
-                }
-                Socket socket(remote_, port);
-                auto &flow(flows_[socket]);
-                orc_insist(flow == nullptr);
+            S<Flow> flow;
+            uint16_t port;
+
+            { const auto shard(shards_[index]());
+            const auto ephemeral(shard->ports_.find(four));
+            if (ephemeral != shard->ports_.end()) {
+                if (syn)
+                    co_return true;
+                port = ephemeral->second;
+                shard->slots_[port / Shards_].used_ = true;
+            } else if (!syn)
+                break;
+            else {
+                port = Claim(*shard, index);
                 flow = Make<Flow>(this, four);
-                lru_.push_back(four);
-                const auto lru_iter(std::prev(lru_.end()));
-                ephemerals_.emplace(four, Ephemeral_{socket, lru_iter});
+                auto &slot(shard->slots_[port / Shards_]);
+                slot.four_ = four;
+                slot.flow_ = flow;
+                slot.used_ = true;
+                shard->ports_.emplace(four, port);
+            } }
+
+            const Socket socket(remote_, port);
+
+            if (flow == nullptr) {
+                Forge(span, tcp, socket, local_);
+                capture_->Land(subset, false);
+            } else {
                 Spawn([
                     beam = std::move(beam),
                     flow,
@@ -701,6 +737,12 @@ void Capture::Start(const std::string &path) {
         eth_directory = "0x918101FB64f467414e9a785aF9566ae69C3e22C5";
         eth_location = "0xEF7bc12e0F6B02fE2cb86Aa659FdC3EBB727E0eD";
         eth_winratio = 0;
+        bond_channels = 1;
+        bond_stripe = "flow";
+        bypass_sctp = false;
+        coalesce_bytes = 0;
+        coalesce_delay = 100;
+        compress_lz4 = 0;
         rpc = "https://eth-mainnet.alchemyapi.io/v2/VwJMm1VlCgpmjULmKeaVAt3Ik4XVwxO0";
         hops = [];
         //stun = "stun:stun.l.google.com:19302";
@@ -716,6 +758,33 @@ void Capture::Start(const std::string &path) {
 
     WinRatio_ = heap.eval<double>("eth_winratio");
 
+    Stripes([&]() {
+        Striping striping;
+        striping.channels_ = unsigned(heap.eval<double>("bond_channels"));
+        const auto stripe(heap.eval<std::string>("bond_stripe"));
+        if (stripe == "first")
+            striping.stripe_ = Stripe::First;
+        else if (stripe == "weighted")
+            striping.stripe_ = Stripe::Weighted;
+        else if (stripe == "flow")
+            striping.stripe_ = Stripe::Flow;
+        else orc_assert_(false, "unknown bond_stripe: " << stripe);
+        return striping;
+    }());
+    Bypasses(heap.eval<bool>("bypass_sctp"));
+    Coalescings([&]() {
+        Coalescing coalescing;
+        coalescing.size_ = size_t(heap.eval<double>("coalesce_bytes"));
+        coalescing.delay_ = unsigned(heap.eval<double>("coalesce_delay"));
+        return coalescing;
+    }());
+    Compressions([&]() {
+        // whether this bills by the wire is up to the server, which says so
+        Compression compression;
+        compression.acceleration_ = int(heap.eval<double>("compress_lz4"));
+        return compression;
+    }());
+
 #if 0
     auto remote(Break<BufferSink<Remote>>());
     const auto host(remote->Host());
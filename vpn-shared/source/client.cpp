@@ -26,6 +26,8 @@
 
 #include "channel.hpp"
 #include "client.hpp"
+#include "coalesce.hpp"
+#include "compress.hpp"
 #include "datagram.hpp"
 #include "locator.hpp"
 #include "protocol.hpp"
@@ -94,6 +96,11 @@ void Client::Transfer(size_t size) {
     Issue(0);
 }
 
+void Client::Refund(size_t size) {
+    const auto locked(locked_());
+    locked->benefit_ -= size;
+}
+
 // XXX: the implications of when this function gets called concern me :(
 cppcoro::shared_task<Bytes> Client::Ring(Address recipient) {
     if (seller_ == Address(0))
@@ -197,20 +204,58 @@ task<void> Client::Open(const S<Origin> &origin) {
         return false;
     });
 
-    auto &bonding(Bond());
+    // a Coalesce splits whatever arrives, and a Compress expands it, but
+    // neither packs what it sends unless the server agrees to it
+    const auto coalesce(Coalescings().size_ != 0);
+    const auto compress(Compressions().acceleration_ != 0);
+    std::vector<Coalesce *> coalesces;
+    std::vector<Compress *> compresses;
+    std::vector<BufferSunk *> bondings;
+    for (unsigned i(0), e(Stripes().channels_); i != e; ++i) {
+        BufferSunk *sunk(&Bond());
+        if (coalesce) {
+            auto &coalesced(sunk->Wire<BufferSink<Coalesce>>());
+            coalesces.emplace_back(&coalesced);
+            sunk = &coalesced;
+        }
+        if (compress) {
+            auto &compressed(sunk->Wire<BufferSink<Compress>>());
+            compresses.emplace_back(&compressed);
+            sunk = &compressed;
+        }
+        bondings.emplace_back(sunk);
+    }
 
-    socket_ = co_await Channel::Wire(bonding, origin, [&]() {
+    bool coalesced(false);
+    socket_ = co_await Channel::Wire(bondings, origin, [&]() {
         Configuration configuration;
         configuration.tls_ = local_;
         return configuration;
     }(), [&](std::string offer) -> task<std::string> {
+        if (coalesce)
+            offer = Propose(std::move(offer), "coalesce");
+        if (compress)
+            offer = Propose(std::move(offer), "compress");
         const auto answer((co_await origin->Fetch("POST", Locator::Parse(url_), {}, offer, verify)).ok());
         if (true || Verbose) {
             Log() << "Offer: " << offer << std::endl;
             Log() << "Answer: " << answer << std::endl;
         }
+        coalesced = Proposed(answer, "coalesce");
+        // nothing can arrive before this answer is applied, so this is first
+        if (Proposed(answer, "compress")) {
+            Compress::Refund refund;
+            if (Proposed(answer, "compress-wire"))
+                refund = [this](size_t size) { Refund(size); };
+            for (const auto compress : compresses)
+                compress->Engage(refund);
+        }
         co_return answer;
-    });
+    }, Bypasses());
+
+    if (coalesced)
+        for (const auto coalesce : coalesces)
+            coalesce->Engage();
 }
 
 task<void> Client::Shut() noexcept {
@@ -71,7 +71,8 @@ class Client :
     const uint256_t prepay_;
 
     struct Locked_ {
-        uint64_t benefit_ = 0;
+        // a Compress can refund bytes it saved before they were counted
+        int64_t benefit_ = 0;
         std::map<Bytes32, std::pair<Ticket, Signature>> pending_;
         uint256_t spent_ = 0;
 
@@ -90,6 +91,7 @@ class Client :
 
     void Issue(uint256_t amount);
     void Transfer(size_t size);
+    void Refund(size_t size);
 
     cppcoro::shared_task<Bytes> Ring(Address recipient);
 